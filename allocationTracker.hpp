@@ -0,0 +1,249 @@
+/**
+ * @file allocationTracker.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Heap traffic tracking, compiled in with -DCHESS_ALLOC_TRACKING only.
+ *  The global operator new/delete are replaced (the header is included by one translation unit per program,
+ *  main.cpp or benchmark.cpp): every allocation is counted with its size, the live bytes and their peak are kept.
+ *  The std::align_val_t forms are replaced too, over-aligned types are counted as the others.
+ *  CHESS_ALLOC_SCOPE(SCOPE) attributes the allocations of a function to Chess::move, isValidMove or the status check.
+ *  Nested scopes count for the outermost one (the isValidMove calls of a status check are the status check's).
+ *  Without the define the macro is empty and the default allocator is used.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ALLOCATIONTRACKER_H_
+#define ALLOCATIONTRACKER_H_
+
+#ifdef CHESS_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace CHESS {
+
+namespace allocation {
+
+enum SCOPE { NONE, MOVE, IS_VALID_MOVE, STATUS, SCOPE_COUNT };
+
+constexpr const char* NAMES[SCOPE_COUNT] = {"other", "move", "isValidMove", "status"};
+
+struct Counters {
+    std::atomic<std::uint64_t> allocations[SCOPE_COUNT] = {};
+    std::atomic<std::uint64_t> bytes[SCOPE_COUNT] = {};
+    std::atomic<std::int64_t> live{0};
+    std::atomic<std::int64_t> peak{0};
+};
+
+inline Counters g_counters;
+inline thread_local SCOPE t_scope = NONE;
+
+// the block starts with its size, 16 bytes keep the default new alignment
+constexpr std::size_t HEADER = 16;
+
+inline void count(std::size_t size) {
+    g_counters.allocations[t_scope].fetch_add(1, std::memory_order_relaxed);
+    g_counters.bytes[t_scope].fetch_add(size, std::memory_order_relaxed);
+    std::int64_t live = g_counters.live.fetch_add(size, std::memory_order_relaxed) + size;
+    std::int64_t peak = g_counters.peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+inline void* allocate(std::size_t size) {
+    char* p_block = static_cast<char*>(std::malloc(size + HEADER));
+    if (!p_block) return nullptr;
+    *reinterpret_cast<std::size_t*>(p_block) = size;
+    count(size);
+    return p_block + HEADER;
+}
+
+// an over-aligned block starts `alignment` bytes before the pointer, the size is in the HEADER bytes before it as well
+inline void* allocate(std::size_t size, std::align_val_t alignment) {
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (align <= HEADER) return allocate(size);
+    if (size > SIZE_MAX - 2 * align) return nullptr;
+    char* p_block = static_cast<char*>(std::aligned_alloc(align, (size + 2 * align - 1) & ~(align - 1))); // a multiple of the alignment
+    if (!p_block) return nullptr;
+    *reinterpret_cast<std::size_t*>(p_block + align - HEADER) = size;
+    count(size);
+    return p_block + align;
+}
+
+// kept out of line: inlined into the callers gcc reports false -Warray-bounds for the header read
+[[gnu::noinline]] inline void deallocate(void* p) {
+    if (!p) return;
+    char* p_block = static_cast<char*>(p) - HEADER;
+    g_counters.live.fetch_sub(*reinterpret_cast<std::size_t*>(p_block), std::memory_order_relaxed);
+    std::free(p_block);
+}
+
+[[gnu::noinline]] inline void deallocate(void* p, std::align_val_t alignment) {
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (align <= HEADER) return deallocate(p);
+    if (!p) return;
+    g_counters.live.fetch_sub(*reinterpret_cast<std::size_t*>(static_cast<char*>(p) - HEADER), std::memory_order_relaxed);
+    std::free(static_cast<char*>(p) - align);
+}
+
+struct Snapshot {
+    std::uint64_t allocations[SCOPE_COUNT] = {};
+    std::uint64_t bytes[SCOPE_COUNT] = {};
+    std::int64_t live = 0;
+    std::int64_t peak = 0;
+
+    std::uint64_t totalAllocations() const {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : allocations) total += n;
+        return total;
+    }
+    std::uint64_t totalBytes() const {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : bytes) total += n;
+        return total;
+    }
+};
+
+inline Snapshot snapshot() {
+    Snapshot s;
+    for (int i = 0; i < SCOPE_COUNT; ++i) {
+        s.allocations[i] = g_counters.allocations[i].load(std::memory_order_relaxed);
+        s.bytes[i] = g_counters.bytes[i].load(std::memory_order_relaxed);
+    }
+    s.live = g_counters.live.load(std::memory_order_relaxed);
+    s.peak = g_counters.peak.load(std::memory_order_relaxed);
+    return s;
+}
+
+// counters of b minus a, live and peak of b
+inline Snapshot operator-(const Snapshot& b, const Snapshot& a) {
+    Snapshot d = b;
+    for (int i = 0; i < SCOPE_COUNT; ++i) {
+        d.allocations[i] -= a.allocations[i];
+        d.bytes[i] -= a.bytes[i];
+    }
+    return d;
+}
+
+class Scope {
+public:
+    explicit Scope(SCOPE scope) : m_outermost(t_scope == NONE) {
+        if (m_outermost) t_scope = scope;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(Scope&&) = delete;
+    ~Scope() {
+        if (m_outermost) t_scope = NONE;
+    }
+
+private:
+    bool m_outermost;
+};
+
+} // allocation
+
+} // CHESS
+
+void* operator new(std::size_t size) {
+    void* p = CHESS::allocation::allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return CHESS::allocation::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return CHESS::allocation::allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    CHESS::allocation::deallocate(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* p = CHESS::allocation::allocate(size, alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CHESS::allocation::allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CHESS::allocation::allocate(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    CHESS::allocation::deallocate(p, alignment);
+}
+
+#define CHESS_ALLOC_SCOPE_CONCAT_(a, b) a##b
+#define CHESS_ALLOC_SCOPE_NAME_(line) CHESS_ALLOC_SCOPE_CONCAT_(chessAllocationScope, line)
+#define CHESS_ALLOC_SCOPE(scope) ::CHESS::allocation::Scope CHESS_ALLOC_SCOPE_NAME_(__LINE__)(::CHESS::allocation::scope)
+
+#else
+
+#define CHESS_ALLOC_SCOPE(scope)
+
+#endif
+
+#endif
@@ -0,0 +1,365 @@
+/**
+ * @file batchValidator.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Batch validation of game archives.
+ *  An archive is a text file with PGN-like layout: optional tag lines ([Event "..."]) and movetext,
+ *  games are separated by a blank line or by the next tag section.
+ *  Movetext tokens are moves in the forms the game accepts, coordinates ("e2e4", "e2-e4") or SAN ("Nf3", "O-O"),
+ *  move numbers, results, {comments} and ;comments are skipped.
+ *
+ *  GameArchiveReader splits the stream at game boundaries, one game at a time.
+ *  BatchValidator fans the games out to a thread pool, every game is replayed on its own Chess
+ *  through Chess::makeMove and Chess::getStatus, the same path the Game uses.
+ *  Results are handed to the sink in input order. At most maxInFlight games are kept in memory
+ *  (queued, being validated or waiting for reordering), so memory is bounded regardless of the input size.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BATCHVALIDATOR_H_
+#define BATCHVALIDATOR_H_
+
+#include "chess.hpp"
+#include "gameArchive.hpp"
+#include "san.hpp"
+#include <istream>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace CHESS {
+
+struct GameRecord {
+    std::size_t index = 0;
+    std::string tags;
+    std::string movetext;
+};
+
+struct GameValidationResult {
+    enum class TERMINATION { NONE, CHECKMATE, STALEMATE, REPETITION, FIFTY_MOVES, INSUFFICIENT_MATERIAL, ILLEGAL_MOVE };
+
+    std::size_t index = 0;
+    std::string result = "*";     // "1-0", "0-1", "1/2-1/2" or "*" if the game is not finished
+    TERMINATION termination = TERMINATION::NONE;
+    int firstIllegalPly = 0;      // 1 based, 0 if all moves are legal
+    int plies = 0;                // number of accepted plies
+    std::string tags;
+    std::vector<Move> moves;      // accepted moves
+};
+
+const char* toString(GameValidationResult::TERMINATION termination) {
+    switch (termination) {
+        case GameValidationResult::TERMINATION::CHECKMATE: return "checkmate";
+        case GameValidationResult::TERMINATION::STALEMATE: return "stalemate";
+        case GameValidationResult::TERMINATION::REPETITION: return "repetition";
+        case GameValidationResult::TERMINATION::FIFTY_MOVES: return "fifty-moves";
+        case GameValidationResult::TERMINATION::INSUFFICIENT_MATERIAL: return "insufficient-material";
+        case GameValidationResult::TERMINATION::ILLEGAL_MOVE: return "illegal";
+        default: return "none";
+    }
+}
+
+class GameArchiveReader {
+public:
+    explicit GameArchiveReader(std::istream& in) : m_in(in) {}
+    GameArchiveReader(const GameArchiveReader&) = delete;
+    GameArchiveReader& operator=(const GameArchiveReader&) = delete;
+    GameArchiveReader(GameArchiveReader&&) = delete;
+    GameArchiveReader& operator=(GameArchiveReader&&) = delete;
+    ~GameArchiveReader() = default;
+
+    bool next(GameRecord&);
+
+private:
+    std::istream& m_in;
+    std::size_t m_index = 0;
+};
+
+// reads the next game, returns false if there are no more games
+bool GameArchiveReader::next(GameRecord& record) {
+    record.tags.clear();
+    record.movetext.clear();
+    std::string line;
+    while (m_in.peek() != std::char_traits<char>::eof()) {
+        // a tag line after the movetext is the beginning of the next game
+        if (m_in.peek() == '[' && !record.movetext.empty()) break;
+        std::getline(m_in, line);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+            if (!record.movetext.empty()) break;
+            continue;
+        }
+        if (line[0] == '[') {
+            record.tags += line;
+            record.tags.push_back('\n');
+        } else {
+            record.movetext += line;
+            record.movetext.push_back(' ');
+        }
+    }
+    if (record.tags.empty() && record.movetext.empty()) return false;
+    record.index = m_index++;
+    return true;
+}
+
+// splits the movetext to the moves, skipping move numbers, results and comments
+std::vector<std::string> getMovetextTokens(const std::string& movetext) {
+    std::vector<std::string> tokens;
+    std::size_t i = 0;
+    while (i < movetext.size()) {
+        char c = movetext[i];
+        if (c == ' ' || c == '\t' || c == '\n') { ++i; continue; }
+        if (c == '{') {
+            i = movetext.find('}', i);
+            i = (i == std::string::npos) ? movetext.size() : i + 1;
+            continue;
+        }
+        if (c == ';') {
+            i = movetext.find('\n', i);
+            if (i == std::string::npos) i = movetext.size();
+            continue;
+        }
+        std::size_t end = movetext.find_first_of(" \t\n{;", i);
+        if (end == std::string::npos) end = movetext.size();
+        std::string token = movetext.substr(i, end - i);
+        i = end;
+        // "12." or "12..." or "12...e5"
+        std::size_t digits = token.find_first_not_of("0123456789");
+        if (digits != 0 && digits != std::string::npos && token[digits] == '.') {
+            token.erase(0, token.find_first_not_of('.', digits));
+        }
+        if (token.empty() || token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") continue;
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// replays the game on its own Chess, every ply goes through Chess::makeMove
+GameValidationResult validateGame(const GameRecord& record) {
+    using TERMINATION = GameValidationResult::TERMINATION;
+    GameValidationResult res;
+    res.index = record.index;
+    res.tags = record.tags;
+
+    Chess chess;
+    chessPiece::COLOR side = chessPiece::COLOR::WHITE;
+    for (std::string token : getMovetextTokens(record.movetext)) {
+        if (res.termination != TERMINATION::NONE) { // a move after the end of the game
+            res.firstIllegalPly = res.plies + 1;
+            break;
+        }
+        Move move = san::parseInput(chess, token);
+        if (move.isNull() || !chess.makeMove(side, move)) {
+            res.firstIllegalPly = res.plies + 1;
+            res.termination = TERMINATION::ILLEGAL_MOVE;
+            break;
+        }
+        ++res.plies;
+        side = (side == chessPiece::COLOR::WHITE) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+        switch (chess.getStatus(side)) {
+            case Chess::STATUS::CHECKMATE:
+                res.termination = TERMINATION::CHECKMATE;
+                res.result = (side == chessPiece::COLOR::BLACK) ? "1-0" : "0-1";
+                break;
+            case Chess::STATUS::STALEMATE:
+                res.termination = TERMINATION::STALEMATE;
+                res.result = "1/2-1/2";
+                break;
+            case Chess::STATUS::REPETITION:
+                res.termination = TERMINATION::REPETITION;
+                res.result = "1/2-1/2";
+                break;
+            case Chess::STATUS::FIFTY_MOVES:
+                res.termination = TERMINATION::FIFTY_MOVES;
+                res.result = "1/2-1/2";
+                break;
+            case Chess::STATUS::INSUFFICIENT_MATERIAL:
+                res.termination = TERMINATION::INSUFFICIENT_MATERIAL;
+                res.result = "1/2-1/2";
+                break;
+            default:
+                break;
+        }
+    }
+    res.moves = chess.getMoveDB();
+    return res;
+}
+
+class BatchValidator {
+public:
+    using Sink = std::function<void(const GameValidationResult&)>;
+
+    explicit BatchValidator(unsigned threads = std::thread::hardware_concurrency(), std::size_t maxInFlight = 0);
+    BatchValidator(const BatchValidator&) = delete;
+    BatchValidator& operator=(const BatchValidator&) = delete;
+    BatchValidator(BatchValidator&&) = delete;
+    BatchValidator& operator=(BatchValidator&&) = delete;
+    ~BatchValidator() = default;
+
+    std::size_t run(std::istream&, const Sink&);
+
+private:
+    void worker();
+
+    unsigned m_threads;
+    std::size_t m_maxInFlight;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_resultReady;
+    std::deque<GameRecord> m_jobs;
+    std::map<std::size_t, GameValidationResult> m_results; // finished games waiting for their turn
+    std::size_t m_inFlight = 0;
+    bool m_done = false;
+};
+
+BatchValidator::BatchValidator(unsigned threads, std::size_t maxInFlight) :
+        m_threads(threads ? threads : 1), m_maxInFlight(maxInFlight ? maxInFlight : 4 * (threads ? threads : 1)) {
+}
+
+void BatchValidator::worker() {
+    while (true) {
+        GameRecord record;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_done || !m_jobs.empty(); });
+            if (m_jobs.empty()) return;
+            record = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        GameValidationResult res = validateGame(record);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.emplace(res.index, std::move(res));
+        }
+        m_resultReady.notify_one();
+    }
+}
+
+// reads the games from the stream and validates them in parallel,
+// the sink is called from the calling thread in the input order. Returns the number of games.
+std::size_t BatchValidator::run(std::istream& in, const Sink& sink) {
+    m_done = false;
+    m_inFlight = 0;
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < m_threads; ++i) {
+        pool.emplace_back(&BatchValidator::worker, this);
+    }
+
+    GameArchiveReader reader(in);
+    std::size_t nextIndex = 0;
+    // hands the ready results to the sink, the lock is released while the sink works
+    auto drain = [&](std::unique_lock<std::mutex>& lock) {
+        auto iter = m_results.find(nextIndex);
+        while (iter != m_results.end()) {
+            GameValidationResult res = std::move(iter->second);
+            m_results.erase(iter);
+            --m_inFlight;
+            ++nextIndex;
+            lock.unlock();
+            sink(res);
+            lock.lock();
+            iter = m_results.find(nextIndex);
+        }
+    };
+
+    GameRecord record;
+    while (reader.next(record)) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        drain(lock);
+        while (m_inFlight >= m_maxInFlight) {
+            m_resultReady.wait(lock, [&] { return m_results.count(nextIndex) != 0; });
+            drain(lock);
+        }
+        m_jobs.push_back(std::move(record));
+        ++m_inFlight;
+        lock.unlock();
+        m_jobReady.notify_one();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_inFlight) {
+            m_resultReady.wait(lock, [&] { return m_results.count(nextIndex) != 0; });
+            drain(lock);
+        }
+        m_done = true;
+    }
+    m_jobReady.notify_all();
+    for (auto& t : pool) {
+        t.join();
+    }
+    return nextIndex;
+}
+
+// prints one line per game: index, result, termination reason, first illegal ply, accepted plies
+int validateArchive(const std::string& path, unsigned threads = std::thread::hardware_concurrency()) {
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) {
+            std::cerr << "Can't open " << path << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = (path == "-") ? std::cin : file;
+    BatchValidator validator(threads);
+    std::size_t illegal = 0;
+    std::size_t games = validator.run(in, [&](const GameValidationResult& res) {
+        if (res.firstIllegalPly) ++illegal;
+        std::cout << res.index + 1 << ' ' << res.result << ' ' << toString(res.termination) << ' '
+                  << res.firstIllegalPly << ' ' << res.plies << '\n';
+    });
+    std::cout << "games: " << games << ", with illegal moves: " << illegal << std::endl;
+    return illegal ? 2 : 0;
+}
+
+// validates the games and appends the legal ones to the binary archive
+int importArchive(const std::string& path, const std::string& archivePath, unsigned threads = std::thread::hardware_concurrency()) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Can't open " << path << std::endl;
+        return 1;
+    }
+    GameArchiveWriter writer(archivePath);
+    BatchValidator validator(threads);
+    std::size_t skipped = 0;
+    std::size_t games = validator.run(in, [&](const GameValidationResult& res) {
+        if (res.firstIllegalPly) {
+            ++skipped;
+            return;
+        }
+        writer.append(res.tags, res.moves, archive::toResult(res.result));
+    });
+    std::cout << "imported: " << games - skipped << ", skipped with illegal moves: " << skipped
+              << ", archive size: " << writer.size() << std::endl;
+    return 0;
+}
+
+// prints an archived game in the import format
+int showArchivedGame(const std::string& archivePath, std::uint64_t id) {
+    GameArchive gameArchive(archivePath);
+    if (id >= gameArchive.size()) {
+        std::cerr << "The archive has " << gameArchive.size() << " games" << std::endl;
+        return 1;
+    }
+    GameView game = gameArchive[id];
+    std::cout << game.tags;
+    std::vector<Move> moves(game.begin(), game.end());
+    std::cout << san::toSanLine(moves) << archive::toString(game.result) << std::endl;
+    return 0;
+}
+
+} // CHESS
+
+#endif
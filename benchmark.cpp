@@ -0,0 +1,379 @@
+/**
+ * @file benchmark.cpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Micro-benchmarks of the rules engine hot paths over a fixed corpus of positions:
+ *  every ply of a few opening/middlegame lines and some endgame setups.
+ *  Every benchmark is warmed up, then timed in several samples over the whole corpus,
+ *  the reported numbers are nanoseconds per call (median, p99 and min of the samples).
+ *
+ *  Build: g++ -std=c++20 -O2 -pthread -o benchmark benchmark.cpp
+ *  Run:   ./benchmark [--samples N] [--filter NAME] [--json FILE]  ("--json -" prints JSON to stdout)
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "chess.hpp"
+#include "evaluation.hpp"
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <iomanip>
+
+namespace CHESS {
+
+namespace benchmark {
+
+using Clock = std::chrono::steady_clock;
+using PIECE = chessPiece::PIECE;
+using COLOR = chessPiece::COLOR;
+
+const std::vector<std::string> LINES = {
+    // Ruy Lopez, closed
+    "e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7 f1e1 b7b5 a4b3 d7d6 c2c3 e8g8 h2h3 c6a5 b3c2 c7c5 d2d4 d8c7 b1d2 c5d4 c3d4 a5c6 d2b3 a6a5 c1e3 a5a4 b3d2 c8d7",
+    // Sicilian Najdorf, English attack
+    "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6 c1e3 e7e5 d4b3 c8e6 f2f3 f8e7 d1d2 e8g8 e1c1 b8d7 g2g4 b7b5 g4g5 b5b4 c3e2 f6e8 f3f4 a6a5 f4f5 a5a4 b3d4 e5d4 e2d4 e6c4",
+    // Queen's gambit declined
+    "d2d4 d7d5 c2c4 e7e6 b1c3 g8f6 c1g5 f8e7 e2e3 e8g8 g1f3 b8d7 a1c1 c7c6 f1d3 d5c4 d3c4 f6d5 g5e7 d8e7 e1g1 d5c3 c1c3 e6e5",
+    // King's Indian, mar del plata
+    "d2d4 g8f6 c2c4 g7g6 b1c3 f8g7 e2e4 d7d6 g1f3 e8g8 f1e2 e7e5 e1g1 b8c6 d4d5 c6e7 f3e1 f6d7 e1d3 f7f5 c1d2 d7f6 f2f3 f5f4 c4c5 g6g5",
+    // French Winawer, poisoned pawn
+    "e2e4 e7e6 d2d4 d7d5 b1c3 f8b4 e4e5 c7c5 a2a3 b4c3 b2c3 g8e7 d1g4 d8c7 g4g7 h8g8 g7h7 c5d4 g1e2 b8c6 f2f4 c8d7",
+    // en passant and open files
+    "e2e4 d7d5 e4e5 f7f5 e5f6 g8f6 d2d4 e7e6 g1f3 f8d6 f1d3 e8g8 e1g1 c7c5 d4c5 d6c5 c1g5 b8c6 b1c3 h7h6 g5h4 g7g5 h4g3 c5d6",
+};
+
+struct Setup {
+    std::vector<PiecePlacement> pieces;
+    COLOR sideToMove;
+};
+
+int sq(const char* name) {
+    return squareIndex(name);
+}
+
+const std::vector<Setup> ENDGAMES = {
+    // rook endgame
+    {{{PIECE::KING, COLOR::WHITE, sq("g1")}, {PIECE::ROOK, COLOR::WHITE, sq("d1")}, {PIECE::PAWN, COLOR::WHITE, sq("a4")},
+      {PIECE::PAWN, COLOR::WHITE, sq("f2")}, {PIECE::PAWN, COLOR::WHITE, sq("g2")}, {PIECE::PAWN, COLOR::WHITE, sq("h2")},
+      {PIECE::KING, COLOR::BLACK, sq("g8")}, {PIECE::ROOK, COLOR::BLACK, sq("d8")}, {PIECE::PAWN, COLOR::BLACK, sq("b6")},
+      {PIECE::PAWN, COLOR::BLACK, sq("f7")}, {PIECE::PAWN, COLOR::BLACK, sq("g7")}, {PIECE::PAWN, COLOR::BLACK, sq("h7")}}, COLOR::WHITE},
+    // queen against minor pieces
+    {{{PIECE::KING, COLOR::WHITE, sq("h1")}, {PIECE::QUEEN, COLOR::WHITE, sq("d4")}, {PIECE::PAWN, COLOR::WHITE, sq("g2")},
+      {PIECE::KING, COLOR::BLACK, sq("h8")}, {PIECE::KNIGHT, COLOR::BLACK, sq("f6")}, {PIECE::BISHOP, COLOR::BLACK, sq("g7")},
+      {PIECE::PAWN, COLOR::BLACK, sq("h7")}}, COLOR::BLACK},
+    // king and pawn
+    {{{PIECE::KING, COLOR::WHITE, sq("e4")}, {PIECE::PAWN, COLOR::WHITE, sq("e5")}, {PIECE::KING, COLOR::BLACK, sq("e7")}}, COLOR::WHITE},
+};
+
+std::vector<std::string> split(const std::string& line) {
+    std::istringstream in(line);
+    std::vector<std::string> moves;
+    std::string move;
+    while (in >> move) {
+        moves.push_back(move);
+    }
+    return moves;
+}
+
+// every prefix of every line, then the endgames
+std::vector<std::unique_ptr<Chess>> buildCorpus() {
+    std::vector<std::unique_ptr<Chess>> corpus;
+    for (const std::string& line : LINES) {
+        std::vector<std::string> moves = split(line);
+        for (std::size_t ply = 0; ply <= moves.size(); ++ply) {
+            auto chess = std::make_unique<Chess>();
+            for (std::size_t i = 0; i < ply; ++i) {
+                if (!chess->makeMove(chess->getSideToMove(), moves[i].substr(0, 2), moves[i].substr(2, 2))) {
+                    throw std::logic_error("Illegal corpus move " + moves[i]);
+                }
+            }
+            corpus.push_back(std::move(chess));
+        }
+    }
+    for (const Setup& setup : ENDGAMES) {
+        auto chess = std::make_unique<Chess>();
+        chess->setupPosition(setup.pieces, setup.sideToMove);
+        corpus.push_back(std::move(chess));
+    }
+    return corpus;
+}
+
+std::vector<chessPiece*>& sideToMovePieces(Chess& chess) {
+    return chess.getSideToMove() == COLOR::WHITE ? chess.whitePieces : chess.blackPieces;
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t calls = 0; // per sample
+    double median = 0;
+    double p99 = 0;
+    double min = 0;
+};
+
+// a sample runs the body once over the corpus, the body returns the number of calls and
+// adds the timed nanoseconds (for bodies which time their calls themselves), or returns 0 in the second
+struct Benchmark {
+    std::string name;
+    std::function<std::uint64_t(std::uint64_t& timedNanoseconds)> body;
+};
+
+Result measure(const Benchmark& benchmark, int samples) {
+    std::uint64_t ignored = 0;
+    for (int i = 0; i < 3; ++i) {
+        benchmark.body(ignored); // warm-up
+    }
+    Result result;
+    result.name = benchmark.name;
+    std::vector<double> perCall;
+    for (int i = 0; i < samples; ++i) {
+        std::uint64_t timed = 0;
+        auto start = Clock::now();
+        std::uint64_t calls = benchmark.body(timed);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        result.calls = calls;
+        perCall.push_back(static_cast<double>(timed ? timed : elapsed) / std::max<std::uint64_t>(calls, 1));
+    }
+    std::sort(perCall.begin(), perCall.end());
+    result.median = perCall[perCall.size() / 2];
+    result.p99 = perCall[std::min(perCall.size() - 1, static_cast<std::size_t>(0.99 * perCall.size()))];
+    result.min = perCall.front();
+    return result;
+}
+
+std::vector<Benchmark> benchmarks(std::vector<std::unique_ptr<Chess>>& corpus) {
+    // candidate moves of the side to move: every piece to every attacked square
+    std::vector<std::vector<std::pair<std::string, std::string>>> candidates;
+    for (auto& chess : corpus) {
+        candidates.emplace_back();
+        for (chessPiece* p_piece : sideToMovePieces(*chess)) {
+            for (const std::string& destination : p_piece->getAttackingSquares()) {
+                candidates.back().emplace_back(p_piece->getPosition(), destination);
+            }
+        }
+    }
+    std::vector<std::string> squares;
+    for (int square = 0; square < 64; ++square) {
+        squares.push_back(squareName(square));
+    }
+
+    std::vector<Benchmark> list;
+    list.push_back({"Chess::isValidMove", [&corpus, candidates](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        for (std::size_t i = 0; i < corpus.size(); ++i) {
+            for (const auto& [source, destination] : candidates[i]) {
+                corpus[i]->isValidMove(source, destination);
+                corpus[i]->resetFlags();
+                ++calls;
+            }
+        }
+        return calls;
+    }});
+    list.push_back({"Chess::getPieceFromPosition", [&corpus, squares](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        std::uintptr_t sink = 0;
+        for (auto& chess : corpus) {
+            for (const std::string& square : squares) {
+                sink ^= reinterpret_cast<std::uintptr_t>(chess->getPieceFromPosition(square));
+                ++calls;
+            }
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    list.push_back({"chessPiece::getAttackingSquares", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        std::size_t sink = 0;
+        for (auto& chess : corpus) {
+            for (auto* pieces : {&chess->whitePieces, &chess->blackPieces}) {
+                for (chessPiece* p_piece : *pieces) {
+                    sink += p_piece->getAttackingSquares().size();
+                    ++calls;
+                }
+            }
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    list.push_back({"chessPiece::getAttackingPath", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        std::size_t sink = 0;
+        for (auto& chess : corpus) {
+            for (auto* pieces : {&chess->whitePieces, &chess->blackPieces}) {
+                for (chessPiece* p_piece : *pieces) {
+                    PIECE piece = p_piece->getPiece();
+                    if (piece != PIECE::QUEEN && piece != PIECE::ROOK && piece != PIECE::BISHOP) continue;
+                    for (const std::string& destination : p_piece->getAttackingSquares()) {
+                        sink += p_piece->getAttackingPath(destination).size();
+                        ++calls;
+                    }
+                }
+            }
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    list.push_back({"chessPiece::collectAttackingSquares", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        std::size_t sink = 0;
+        SquareList squares;
+        for (auto& chess : corpus) {
+            for (auto* pieces : {&chess->whitePieces, &chess->blackPieces}) {
+                for (chessPiece* p_piece : *pieces) {
+                    squares.clear();
+                    p_piece->collectAttackingSquares(squares);
+                    sink += squares.size();
+                    ++calls;
+                }
+            }
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    list.push_back({"chessPiece::collectAttackingPath", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        std::size_t sink = 0;
+        SquareList squares, path;
+        for (auto& chess : corpus) {
+            for (auto* pieces : {&chess->whitePieces, &chess->blackPieces}) {
+                for (chessPiece* p_piece : *pieces) {
+                    PIECE piece = p_piece->getPiece();
+                    if (piece != PIECE::QUEEN && piece != PIECE::ROOK && piece != PIECE::BISHOP) continue;
+                    squares.clear();
+                    p_piece->collectAttackingSquares(squares);
+                    for (int destination : squares) {
+                        path.clear();
+                        p_piece->collectAttackingPath(destination, path);
+                        sink += path.size();
+                        ++calls;
+                    }
+                }
+            }
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    list.push_back({"Chess::isWhiteCheckMated", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        for (auto& chess : corpus) {
+            chess->isWhiteCheckMated();
+            ++calls;
+        }
+        return calls;
+    }});
+    list.push_back({"Chess::isBlackStalemate", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        for (auto& chess : corpus) {
+            chess->isBlackStalemate();
+            ++calls;
+        }
+        return calls;
+    }});
+    list.push_back({"Chess::isRepetition", [&corpus](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        for (auto& chess : corpus) {
+            chess->isRepetition();
+            ++calls;
+        }
+        return calls;
+    }});
+    // replays the lines on fresh boards, only the move calls are timed (isValidMove sets the special move flags first)
+    list.push_back({"Chess::move", [](std::uint64_t& timed) {
+        std::uint64_t calls = 0;
+        for (const std::string& line : LINES) {
+            Chess chess;
+            for (const std::string& move : split(line)) {
+                std::string source = move.substr(0, 2), destination = move.substr(2, 2);
+                chess.isValidMove(source, destination);
+                auto start = Clock::now();
+                chess.move(source, destination);
+                timed += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                chess.resetFlags();
+                ++calls;
+            }
+        }
+        return calls;
+    }});
+    // the corpus positions repeated to a few thousand, the same positions for the scalar and the batch evaluation
+    std::vector<Position> positions;
+    for (int copy = 0; copy < 24; ++copy) {
+        for (auto& chess : corpus) {
+            positions.push_back(chess->getPosition());
+        }
+    }
+    evaluation::PositionBatch batch;
+    for (const Position& position : positions) {
+        batch.push_back(position);
+    }
+    list.push_back({"evaluation::evaluate", [positions](std::uint64_t&) {
+        std::uint64_t calls = 0;
+        int sink = 0;
+        for (const Position& position : positions) {
+            sink += evaluation::evaluate(position).total();
+            ++calls;
+        }
+        asm volatile("" : : "r"(sink));
+        return calls;
+    }});
+    // ns per position
+    list.push_back({"evaluation::evaluateBatch", [batch](std::uint64_t&) {
+        evaluation::BatchScores scores;
+        evaluation::evaluateBatch(batch, scores);
+        asm volatile("" : : "r"(scores.material.data()) : "memory");
+        return static_cast<std::uint64_t>(batch.size());
+    }});
+    return list;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results, std::size_t positions, int samples) {
+    out << "{\n  \"positions\": " << positions << ",\n  \"samples\": " << samples << ",\n  \"unit\": \"ns/call\",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"calls\": " << r.calls << std::fixed << std::setprecision(1)
+            << ", \"median\": " << r.median << ", \"p99\": " << r.p99 << ", \"min\": " << r.min << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}" << std::endl;
+}
+
+} // benchmark
+
+} // CHESS
+
+int main(int argc, char* argv[]) {
+    using namespace CHESS::benchmark;
+    int samples = 25;
+    std::string filter;
+    std::string jsonPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--samples") samples = std::max(1, std::stoi(argv[i + 1]));
+        if (option == "--filter") filter = argv[i + 1];
+        if (option == "--json") jsonPath = argv[i + 1];
+    }
+
+    auto corpus = buildCorpus();
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : benchmarks(corpus)) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+        results.push_back(measure(benchmark, samples));
+        const Result& r = results.back();
+        if (jsonPath != "-") {
+            std::cout << std::left << std::setw(34) << r.name << std::right << std::fixed << std::setprecision(1)
+                      << " median " << std::setw(10) << r.median << " ns  p99 " << std::setw(10) << r.p99
+                      << " ns  min " << std::setw(10) << r.min << " ns  (" << r.calls << " calls)" << std::endl;
+        }
+    }
+    if (jsonPath == "-") {
+        writeJson(std::cout, results, corpus.size(), samples);
+    } else if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        writeJson(out, results, corpus.size(), samples);
+    }
+}
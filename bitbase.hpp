@@ -0,0 +1,508 @@
+/**
+ * @file bitbase.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Locally generated win/draw/loss bitbases for small material signatures (KPK, KRK, KQK, KBNK, KQKR ...).
+ *
+ *  A signature is "K" + white pieces + "K" + black pieces, pieces in QRBNP order (canonical form).
+ *  A table holds a value for every (side to move, square of every piece) combination:
+ *  index = sideToMove * 64^n + sum(square_i * 64^i), pieces in the signature order.
+ *  Values are from the side to move's point of view, 2 bits per position.
+ *
+ *  Generation is a retrograde analysis over the project's own rules:
+ *   1. every position is set up on a Chess and its moves come from Chess::getLegalMoves (on several threads),
+ *      quiet moves are kept as one byte (piece, destination), captures and promotions lead to another
+ *      signature which is generated first (recursively) and is resolved right away.
+ *   2. positions are resolved in passes until nothing changes: a win if a move leads to a loss of the opponent,
+ *      a loss if all moves lead to a win of the opponent. The rest are draws.
+ *  En passant is not considered, as the tables don't store the last move.
+ *
+ *  Bitbase maps the generated file and finds the tables by material key (material.hpp), every key of a signature
+ *  points to its table. A probe of a Chess or a Position places the pieces in a fixed array, looks the key up,
+ *  computes the index and reads 2 bits, without allocations. Positions with colors swapped are probed through
+ *  the mirrored table.
+ *  Memory during the generation is about 1 byte per move + 6 bytes per position (~1 GB for a 4 pieces table).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BITBASE_H_
+#define BITBASE_H_
+
+#include "chess.hpp"
+#include "material.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CHESS {
+
+namespace bitbase {
+
+enum VALUE : std::uint8_t { DRAW = 0, WIN = 1, LOSS = 2, UNKNOWN = 3 };
+
+constexpr char MAGIC[8] = {'C', 'H', 'S', 'B', 'B', 'A', 'S', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr int MAX_PIECES = 4;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t tableCount;
+};
+
+struct TableEntry {
+    char signature[8];
+    std::uint64_t offset;
+    std::uint64_t positions;
+};
+
+static_assert(sizeof(Header) == 16 && sizeof(TableEntry) == 24, "On-disk layout");
+
+struct Piece {
+    chessPiece::PIECE piece;
+    chessPiece::COLOR color;
+};
+
+int pieceOrder(chessPiece::PIECE piece) {
+    switch (piece) {
+        case chessPiece::PIECE::KING: return 0;
+        case chessPiece::PIECE::QUEEN: return 1;
+        case chessPiece::PIECE::ROOK: return 2;
+        case chessPiece::PIECE::BISHOP: return 3;
+        case chessPiece::PIECE::KNIGHT: return 4;
+        default: return 5;
+    }
+}
+
+char pieceLetter(chessPiece::PIECE piece) {
+    return "KQRBNP"[pieceOrder(piece)];
+}
+
+// canonical order: white before black, then KQRBNP
+bool canonicalLess(chessPiece::COLOR colorA, chessPiece::PIECE pieceA, chessPiece::COLOR colorB, chessPiece::PIECE pieceB) {
+    if (colorA != colorB) return colorA == chessPiece::COLOR::WHITE;
+    return pieceOrder(pieceA) < pieceOrder(pieceB);
+}
+
+// "KBNK" -> pieces in canonical order, empty if the signature is malformed
+std::vector<Piece> parseSignature(const std::string& signature) {
+    std::vector<Piece> pieces;
+    int kings = 0;
+    for (char c : signature) {
+        chessPiece::PIECE piece;
+        switch (c) {
+            case 'K': piece = chessPiece::PIECE::KING; ++kings; break;
+            case 'Q': piece = chessPiece::PIECE::QUEEN; break;
+            case 'R': piece = chessPiece::PIECE::ROOK; break;
+            case 'B': piece = chessPiece::PIECE::BISHOP; break;
+            case 'N': piece = chessPiece::PIECE::KNIGHT; break;
+            case 'P': piece = chessPiece::PIECE::PAWN; break;
+            default: return {};
+        }
+        if (kings == 0) return {};
+        pieces.push_back({piece, kings == 1 ? chessPiece::COLOR::WHITE : chessPiece::COLOR::BLACK});
+    }
+    if (kings != 2 || pieces.size() > MAX_PIECES) return {};
+    std::stable_sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) {
+        return canonicalLess(a.color, a.piece, b.color, b.piece);
+    });
+    return pieces;
+}
+
+std::string toSignature(const std::vector<Piece>& pieces) {
+    std::string signature;
+    for (const Piece& p : pieces) {
+        signature.push_back(pieceLetter(p.piece));
+    }
+    return signature;
+}
+
+std::uint64_t tableSize(std::size_t pieceCount) {
+    return std::uint64_t(2) << (6 * pieceCount);
+}
+
+// index of placed pieces (already in the canonical order of their table)
+std::uint64_t tableIndex(const PiecePlacement* placements, std::size_t count, chessPiece::COLOR sideToMove) {
+    std::uint64_t index = 0;
+    for (std::size_t i = count; i-- > 0;) {
+        index = (index << 6) | placements[i].square;
+    }
+    if (sideToMove == chessPiece::COLOR::BLACK) index |= std::uint64_t(1) << (6 * count);
+    return index;
+}
+
+std::uint64_t tableIndex(const std::vector<PiecePlacement>& placements, chessPiece::COLOR sideToMove) {
+    return tableIndex(placements.data(), placements.size(), sideToMove);
+}
+
+void sortCanonical(std::vector<PiecePlacement>& placements) {
+    std::stable_sort(placements.begin(), placements.end(), [](const PiecePlacement& a, const PiecePlacement& b) {
+        return canonicalLess(a.color, a.piece, b.color, b.piece);
+    });
+}
+
+} // bitbase
+
+class BitbaseGenerator {
+public:
+    explicit BitbaseGenerator(unsigned threads = std::thread::hardware_concurrency()) : m_threads(threads ? threads : 1) {}
+    BitbaseGenerator(const BitbaseGenerator&) = delete;
+    BitbaseGenerator& operator=(const BitbaseGenerator&) = delete;
+    BitbaseGenerator(BitbaseGenerator&&) = delete;
+    BitbaseGenerator& operator=(BitbaseGenerator&&) = delete;
+    ~BitbaseGenerator() = default;
+
+    void generate(const std::string& signature);
+    void write(const std::string& path) const;
+    const std::map<std::string, std::vector<std::uint8_t>>& getTables() const {
+        return m_tables;
+    }
+
+private:
+    struct Chunk {
+        std::vector<std::uint8_t> moves;  // (piece << 6) | destination for quiet moves
+        std::vector<std::uint8_t> counts; // quiet moves per position, ESCAPE bit if a move to another table doesn't lose
+    };
+
+    void generateTable(const std::vector<bitbase::Piece>&);
+    std::uint8_t externalValue(const std::vector<PiecePlacement>&, chessPiece::COLOR) const;
+
+    unsigned m_threads;
+    std::map<std::string, std::vector<std::uint8_t>> m_tables; // one value per position
+};
+
+// generates the table and every table it depends on
+void BitbaseGenerator::generate(const std::string& signature) {
+    auto pieces = bitbase::parseSignature(signature);
+    if (pieces.empty()) throw std::logic_error("Invalid material signature " + signature + "\n");
+    if (m_tables.count(bitbase::toSignature(pieces))) return;
+    // captures and promotions lead to these signatures
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        if (pieces[i].piece == chessPiece::PIECE::KING) continue;
+        auto captured = pieces;
+        captured.erase(captured.begin() + i);
+        generate(bitbase::toSignature(captured));
+        if (pieces[i].piece == chessPiece::PIECE::PAWN) {
+            auto promoted = pieces;
+            promoted[i].piece = chessPiece::PIECE::QUEEN;
+            std::stable_sort(promoted.begin(), promoted.end(), [](const bitbase::Piece& a, const bitbase::Piece& b) {
+                return bitbase::canonicalLess(a.color, a.piece, b.color, b.piece);
+            });
+            generate(bitbase::toSignature(promoted));
+        }
+    }
+    generateTable(pieces);
+}
+
+// value of a position of an already generated table, from the side to move's point of view
+std::uint8_t BitbaseGenerator::externalValue(const std::vector<PiecePlacement>& placements, chessPiece::COLOR sideToMove) const {
+    std::vector<PiecePlacement> sorted = placements;
+    bitbase::sortCanonical(sorted);
+    std::vector<bitbase::Piece> pieces;
+    for (const PiecePlacement& p : sorted) {
+        pieces.push_back({p.piece, p.color});
+    }
+    return m_tables.at(bitbase::toSignature(pieces))[bitbase::tableIndex(sorted, sideToMove)];
+}
+
+void BitbaseGenerator::generateTable(const std::vector<bitbase::Piece>& pieces) {
+    using namespace bitbase;
+    const std::size_t n = pieces.size();
+    const std::uint64_t size = tableSize(n);
+    const std::uint64_t CHUNK_SIZE = 4096;
+    const std::uint8_t ESCAPE = 0x80;
+    const std::uint64_t chunkCount = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::atomic<std::uint8_t>> values(size);
+    std::vector<Chunk> chunks(chunkCount);
+
+    // 1. legal moves of every position, terminal positions and moves to other tables are resolved here
+    std::atomic<std::uint64_t> nextChunk{0};
+    auto setup = [&]() {
+        Chess chess;
+        std::vector<Move> moves;
+        std::vector<PiecePlacement> placements(n);
+        while (true) {
+            std::uint64_t c = nextChunk.fetch_add(1);
+            if (c >= chunkCount) break;
+            Chunk& chunk = chunks[c];
+            for (std::uint64_t index = c * CHUNK_SIZE; index < std::min(size, (c + 1) * CHUNK_SIZE); ++index) {
+                std::uint8_t count = 0;
+                std::uint8_t value = DRAW;
+                chessPiece::COLOR sideToMove = (index >> (6 * n)) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+                std::uint64_t occupied = 0;
+                bool valid = true;
+                for (std::size_t i = 0; i < n; ++i) {
+                    int square = (index >> (6 * i)) & 63;
+                    placements[i] = {pieces[i].piece, pieces[i].color, square};
+                    if (occupied & (std::uint64_t(1) << square)) valid = false;
+                    occupied |= std::uint64_t(1) << square;
+                    if (pieces[i].piece == chessPiece::PIECE::PAWN && (square < 8 || square >= 56)) valid = false;
+                }
+                int whiteKing = placements[0].square;
+                int blackKing = 0;
+                for (const PiecePlacement& p : placements) {
+                    if (p.piece == chessPiece::PIECE::KING && p.color == chessPiece::COLOR::BLACK) blackKing = p.square;
+                }
+                if (std::abs(whiteKing % 8 - blackKing % 8) <= 1 && std::abs(whiteKing / 8 - blackKing / 8) <= 1) valid = false;
+                if (valid) {
+                    chess.setupPosition(placements, sideToMove);
+                    // the side which has just moved can't be in check
+                    valid = (sideToMove == chessPiece::COLOR::WHITE) ? !chess.isBlackKingUnderAttack() : !chess.isWhiteKingUnderAttack();
+                }
+                if (valid) {
+                    value = UNKNOWN;
+                    chess.getLegalMoves(moves);
+                    bool inCheck = (sideToMove == chessPiece::COLOR::WHITE) ? chess.isWhiteKingUnderAttack() : chess.isBlackKingUnderAttack();
+                    if (moves.empty()) value = inCheck ? LOSS : DRAW;
+                    bool allExternalWin = true; // all moves to other tables lead to a win of the opponent
+                    bool external = false;
+                    for (Move move : moves) {
+                        std::size_t moved = 0;
+                        while (placements[moved].square != move.from()) ++moved;
+                        bool capture = occupied & (std::uint64_t(1) << move.to());
+                        if (!capture && move.type() != Move::TYPE::PROMOTION) {
+                            chunk.moves.push_back(static_cast<std::uint8_t>((moved << 6) | move.to()));
+                            ++count;
+                            continue;
+                        }
+                        std::vector<PiecePlacement> next;
+                        for (std::size_t i = 0; i < n; ++i) {
+                            if (placements[i].square == move.to()) continue; // captured
+                            next.push_back(placements[i]);
+                            if (i == moved) {
+                                next.back().square = move.to();
+                                if (move.type() == Move::TYPE::PROMOTION) next.back().piece = chessPiece::PIECE::QUEEN;
+                            }
+                        }
+                        external = true;
+                        std::uint8_t nextValue = externalValue(next, sideToMove == chessPiece::COLOR::WHITE ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE);
+                        if (nextValue == LOSS) value = WIN;
+                        if (nextValue != WIN) allExternalWin = false;
+                    }
+                    if (value == UNKNOWN && external && !allExternalWin) count |= ESCAPE;
+                }
+                if (value != UNKNOWN) {
+                    // resolved positions don't need their moves
+                    chunk.moves.resize(chunk.moves.size() - count);
+                    count = 0;
+                }
+                chunk.counts.push_back(count);
+                values[index].store(value, std::memory_order_relaxed);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < m_threads; ++t) pool.emplace_back(setup);
+    for (auto& t : pool) t.join();
+    pool.clear();
+
+    // 2. passes until nothing changes, positions are updated in place (values only go from UNKNOWN to WIN or LOSS)
+    const std::uint64_t stmBit = std::uint64_t(1) << (6 * n);
+    std::atomic<bool> changed{true};
+    while (changed) {
+        changed = false;
+        nextChunk = 0;
+        auto pass = [&]() {
+            bool localChange = false;
+            while (true) {
+                std::uint64_t c = nextChunk.fetch_add(1);
+                if (c >= chunkCount) break;
+                const Chunk& chunk = chunks[c];
+                std::size_t offset = 0;
+                for (std::uint64_t i = 0; i < chunk.counts.size(); ++i) {
+                    std::uint64_t index = c * CHUNK_SIZE + i;
+                    std::uint8_t count = chunk.counts[i] & ~ESCAPE;
+                    const std::uint8_t* moves = chunk.moves.data() + offset;
+                    offset += count;
+                    if (values[index].load(std::memory_order_relaxed) != UNKNOWN) continue;
+                    bool allWin = !(chunk.counts[i] & ESCAPE);
+                    bool win = false;
+                    for (std::uint8_t m = 0; m < count && !win; ++m) {
+                        int piece = moves[m] >> 6;
+                        std::uint64_t next = (index ^ stmBit) & ~(std::uint64_t(63) << (6 * piece));
+                        next |= std::uint64_t(moves[m] & 63) << (6 * piece);
+                        std::uint8_t nextValue = values[next].load(std::memory_order_relaxed);
+                        if (nextValue == LOSS) win = true;
+                        if (nextValue != WIN) allWin = false;
+                    }
+                    if (win || allWin) {
+                        values[index].store(win ? WIN : LOSS, std::memory_order_relaxed);
+                        localChange = true;
+                    }
+                }
+            }
+            if (localChange) changed = true;
+        };
+        for (unsigned t = 0; t < m_threads; ++t) pool.emplace_back(pass);
+        for (auto& t : pool) t.join();
+        pool.clear();
+    }
+
+    std::vector<std::uint8_t>& table = m_tables[toSignature(pieces)];
+    table.resize(size);
+    for (std::uint64_t i = 0; i < size; ++i) {
+        std::uint8_t value = values[i].load(std::memory_order_relaxed);
+        table[i] = (value == UNKNOWN) ? static_cast<std::uint8_t>(DRAW) : value;
+    }
+}
+
+// all generated tables, 2 bits per position
+void BitbaseGenerator::write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Can't create the bitbase " + path);
+    bitbase::Header header{};
+    std::memcpy(header.magic, bitbase::MAGIC, sizeof(bitbase::MAGIC));
+    header.version = bitbase::VERSION;
+    header.tableCount = m_tables.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t offset = sizeof(header) + m_tables.size() * sizeof(bitbase::TableEntry);
+    for (const auto& [signature, table] : m_tables) {
+        bitbase::TableEntry entry{};
+        std::memcpy(entry.signature, signature.data(), signature.size());
+        entry.offset = offset;
+        entry.positions = table.size();
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        offset += (table.size() + 3) / 4;
+    }
+    for (const auto& [signature, table] : m_tables) {
+        std::vector<std::uint8_t> packed((table.size() + 3) / 4, 0);
+        for (std::uint64_t i = 0; i < table.size(); ++i) {
+            packed[i / 4] |= table[i] << (2 * (i % 4));
+        }
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    if (!out) throw std::runtime_error("Bitbase write failure " + path);
+}
+
+class Bitbase {
+public:
+    explicit Bitbase(const std::string& path);
+    Bitbase(const Bitbase&) = delete;
+    Bitbase& operator=(const Bitbase&) = delete;
+    Bitbase(Bitbase&&) = delete;
+    Bitbase& operator=(Bitbase&&) = delete;
+    ~Bitbase();
+
+    bitbase::VALUE probe(const Chess&) const;
+    bitbase::VALUE probe(const Position&) const;
+    bitbase::VALUE probe(const std::string& signature, std::uint64_t index) const;
+    bool contains(const std::string& signature) const {
+        return m_tables.count(signature) != 0;
+    }
+
+private:
+    using Placements = std::array<PiecePlacement, bitbase::MAX_PIECES>;
+
+    bitbase::VALUE probe(std::uint64_t materialKey, Placements& placements, std::size_t count, chessPiece::COLOR sideToMove) const;
+    const unsigned char* table(std::uint64_t materialKey) const;
+
+    const unsigned char* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::map<std::string, const unsigned char*> m_tables;
+    std::vector<std::pair<std::uint64_t, const unsigned char*>> m_materialTables; // sorted by material key
+};
+
+Bitbase::Bitbase(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Can't open the bitbase " + path);
+    struct stat st;
+    ::fstat(fd, &st);
+    m_size = st.st_size;
+    void* data = m_size >= sizeof(bitbase::Header) ? ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("Can't map the bitbase " + path);
+    m_data = static_cast<const unsigned char*>(data);
+    const bitbase::Header* header = reinterpret_cast<const bitbase::Header*>(m_data);
+    if (std::memcmp(header->magic, bitbase::MAGIC, sizeof(bitbase::MAGIC)) != 0 || header->version != bitbase::VERSION) {
+        ::munmap(data, m_size);
+        throw std::runtime_error("Not a bitbase " + path);
+    }
+    const bitbase::TableEntry* entries = reinterpret_cast<const bitbase::TableEntry*>(m_data + sizeof(bitbase::Header));
+    for (std::uint32_t i = 0; i < header->tableCount; ++i) {
+        std::string signature(entries[i].signature, strnlen(entries[i].signature, sizeof(entries[i].signature)));
+        m_tables[signature] = m_data + entries[i].offset;
+        for (std::uint64_t key : material::keysOf(signature)) {
+            m_materialTables.emplace_back(key, m_data + entries[i].offset);
+        }
+    }
+    std::sort(m_materialTables.begin(), m_materialTables.end());
+}
+
+Bitbase::~Bitbase() {
+    ::munmap(const_cast<unsigned char*>(m_data), m_size);
+}
+
+bitbase::VALUE Bitbase::probe(const std::string& signature, std::uint64_t index) const {
+    auto iter = m_tables.find(signature);
+    if (iter == m_tables.end()) return bitbase::UNKNOWN;
+    return static_cast<bitbase::VALUE>((iter->second[index / 4] >> (2 * (index % 4))) & 3);
+}
+
+// nullptr if the material is not in the bitbase
+const unsigned char* Bitbase::table(std::uint64_t materialKey) const {
+    auto iter = std::lower_bound(m_materialTables.begin(), m_materialTables.end(), std::make_pair(materialKey, static_cast<const unsigned char*>(nullptr)));
+    return (iter != m_materialTables.end() && iter->first == materialKey) ? iter->second : nullptr;
+}
+
+// value for the side to move, UNKNOWN if the material is not in the bitbase
+bitbase::VALUE Bitbase::probe(const Chess& chess) const {
+    if (chess.whitePieces.size() + chess.blackPieces.size() > bitbase::MAX_PIECES) return bitbase::UNKNOWN;
+    Placements placements;
+    std::size_t count = 0;
+    for (const auto* pieces : {&chess.whitePieces, &chess.blackPieces}) {
+        for (const chessPiece* p_piece : *pieces) {
+            placements[count++] = {p_piece->getPiece(), p_piece->getColor(), squareIndex(p_piece->getPosition())};
+        }
+    }
+    return probe(chess.getMaterialKey(), placements, count, chess.getSideToMove());
+}
+
+bitbase::VALUE Bitbase::probe(const Position& position) const {
+    if (std::popcount(position.occupancy()) > bitbase::MAX_PIECES) return bitbase::UNKNOWN;
+    Placements placements;
+    std::size_t count = 0;
+    for (std::uint64_t occupied = position.occupancy(); occupied; occupied &= occupied - 1) {
+        int square = std::countr_zero(occupied);
+        placements[count++] = {position.pieceAt(square), position.colorAt(square), square};
+    }
+    return probe(material::keyOf(position), placements, count, position.side());
+}
+
+bitbase::VALUE Bitbase::probe(std::uint64_t materialKey, Placements& placements, std::size_t count, chessPiece::COLOR sideToMove) const {
+    const unsigned char* data = table(materialKey);
+    if (!data) {
+        // the same position with the colors swapped and the board flipped
+        data = table(material::mirrored(materialKey));
+        if (!data) return bitbase::UNKNOWN;
+        for (std::size_t i = 0; i < count; ++i) {
+            placements[i].color = (placements[i].color == chessPiece::COLOR::WHITE) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+            placements[i].square ^= 56;
+        }
+        sideToMove = (sideToMove == chessPiece::COLOR::WHITE) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+    }
+    // the canonical order, an insertion sort of at most MAX_PIECES
+    for (std::size_t i = 1; i < count; ++i) {
+        for (std::size_t j = i; j > 0 && bitbase::canonicalLess(placements[j].color, placements[j].piece, placements[j - 1].color, placements[j - 1].piece); --j) {
+            std::swap(placements[j], placements[j - 1]);
+        }
+    }
+    const std::uint64_t index = bitbase::tableIndex(placements.data(), count, sideToMove);
+    return static_cast<bitbase::VALUE>((data[index / 4] >> (2 * (index % 4))) & 3);
+}
+
+} // CHESS
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file boardRenderer.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Terminal renderer of the chessBoard matrix.
+ *  A frame is built in one UTF-8 buffer and written with a single write call.
+ *  On a terminal the first frame clears the screen and draws the whole board at the top,
+ *  the next frames rewrite only the changed cells with cursor addressing and clear the text below the board.
+ *  A frame without changes writes nothing, so invalid input doesn't redraw the board.
+ *  The cells are addressed from the top of the screen: once text was printed under the board (it may have
+ *  scrolled the screen), reset() makes the next frame with changes a full one again.
+ *  The squares of the last move can be highlighted (reverse video).
+ *  When stdout is not a terminal every changed frame is the plain board.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BOARDRENDERER_H_
+#define BOARDRENDERER_H_
+
+#include "chessBoard.hpp"
+#include "move.hpp"
+#include <cstdio>
+#include <unistd.h>
+
+namespace CHESS {
+
+class BoardRenderer {
+public:
+    explicit BoardRenderer(int fd = STDOUT_FILENO) : m_fd(fd), m_terminal(::isatty(fd)) {}
+    BoardRenderer(const BoardRenderer&) = default;
+    BoardRenderer& operator=(const BoardRenderer&) = default;
+    BoardRenderer(BoardRenderer&&) = default;
+    BoardRenderer& operator=(BoardRenderer&&) = default;
+    ~BoardRenderer() = default;
+
+    void render(const chessBoard&, Move lastMove = Move());
+    void reset() { // text was printed under the board, the next frame with changes is drawn in full
+        m_stale = true;
+    }
+    void setHighlightLastMove(bool highlight) {
+        m_highlight = highlight;
+    }
+
+private:
+    static void appendUtf8(std::string&, wchar_t);
+    bool isHighlighted(std::size_t row, std::size_t column, Move lastMove) const;
+    void appendCell(std::string& frame, wchar_t c, bool highlighted) const;
+
+    int m_fd;
+    bool m_terminal;
+    bool m_highlight = true;
+    bool m_stale = false; // the screen may have scrolled since the last frame
+    std::vector<std::vector<wchar_t>> m_previous;
+    Move m_previousMove;
+};
+
+void BoardRenderer::appendUtf8(std::string& out, wchar_t wc) {
+    std::uint32_t c = static_cast<std::uint32_t>(wc);
+    if (c < 0x80) {
+        out.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+}
+
+// matrix cell of a square: rows 1-8 are the ranks 8-1, columns 2, 4, ... 16 are the files a-h
+bool BoardRenderer::isHighlighted(std::size_t row, std::size_t column, Move lastMove) const {
+    if (!m_highlight || lastMove.isNull() || row < 1 || row > 8 || column < 2 || column > 16 || column % 2) return false;
+    int square = static_cast<int>((8 - row) * 8 + (column - 2) / 2);
+    return square == lastMove.from() || square == lastMove.to();
+}
+
+void BoardRenderer::appendCell(std::string& frame, wchar_t c, bool highlighted) const {
+    if (highlighted) frame += "\x1b[7m";
+    appendUtf8(frame, c);
+    if (highlighted) frame += "\x1b[0m";
+}
+
+void BoardRenderer::render(const chessBoard& board, Move lastMove) {
+    const auto& matrix = board.getMatrix();
+    std::string frame;
+    if (matrix == m_previous && (lastMove == m_previousMove || !m_highlight)) return;
+    if (!m_terminal || m_previous.empty() || m_stale) {
+        if (m_terminal) frame += "\x1b[H\x1b[2J";
+        for (std::size_t row = 0; row < matrix.size(); ++row) {
+            for (std::size_t column = 0; column < matrix[row].size(); ++column) {
+                appendCell(frame, matrix[row][column], m_terminal && isHighlighted(row, column, lastMove));
+            }
+            frame.push_back('\n');
+        }
+    } else {
+        for (std::size_t row = 0; row < matrix.size(); ++row) {
+            for (std::size_t column = 0; column < matrix[row].size(); ++column) {
+                bool highlighted = isHighlighted(row, column, lastMove);
+                if (matrix[row][column] == m_previous[row][column] && highlighted == isHighlighted(row, column, m_previousMove)) continue;
+                frame += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(column + 1) + "H";
+                appendCell(frame, matrix[row][column], highlighted);
+            }
+        }
+        if (!frame.empty()) frame += "\x1b[" + std::to_string(matrix.size() + 1) + ";1H\x1b[J"; // below the board
+    }
+    m_previous = matrix;
+    m_previousMove = lastMove;
+    m_stale = false;
+    if (frame.empty()) return;
+
+    std::wcout.flush(); // keep the order with the text printed through the streams
+    std::fflush(stdout);
+    std::size_t written = 0;
+    while (written < frame.size()) {
+        ssize_t n = ::write(m_fd, frame.data() + written, frame.size() - written);
+        if (n <= 0) break;
+        written += n;
+    }
+}
+
+} // CHESS
+
+#endif
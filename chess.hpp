@@ -8,10 +8,11 @@
  *  Every function is briefly commented, some confusing parts are descibed in details.
  *  Those functions which name describes what it does clearly, have no comments.
  *  If a function for white is commented, for black is skipped.
- *  All moves are saved in moveDB.
+ *  All moves are saved in moveDB as packed 16 bit Moves (see move.hpp).
  *  Rule of 5 is supported for every class(chessBoard, chessPiece, chess).
  *  chess class suports all chess game rules, including checkMate, enPassant capturing,
- *  automate pawn->queen promotion, stalemate check, 3 last moves repetition.
+ *  automate pawn->queen promotion, stalemate check, 3 last moves repetition,
+ *  fifty-move rule and insufficient material draws.
  * 
  * @version 0.1
  * @date 2022-11-27
@@ -25,11 +26,25 @@
 
 #include "chessBoard.hpp"
 #include "chessPiece.hpp"
+#include "move.hpp"
+#include "zobrist.hpp"
+#include "position.hpp"
+#include "material.hpp"
+#include "allocationTracker.hpp"
 
 namespace CHESS {
 
+struct PiecePlacement {
+    chessPiece::PIECE piece;
+    chessPiece::COLOR color;
+    int square; // squareIndex
+};
+
 class Chess {
 public: 
+    enum class STATUS { NONE, CHECKMATE, STALEMATE, REPETITION, FIFTY_MOVES, INSUFFICIENT_MATERIAL };
+    static constexpr int FIFTY_MOVES_PLIES = 100; // without a capture or a pawn move
+
     Chess();
     Chess(const Chess&) = delete;
     Chess& operator=(const Chess&) = delete;
@@ -38,42 +53,99 @@ public:
     ~Chess();
 
     void showBoard() const;
+    const chessBoard& getBoard() const {
+        return *m_chessBoard;
+    }
     void setWhitePieces();
     void setBlackPieces();
 
     chessPiece* getPieceFromPosition(const std::string&) const;
-    bool isWhiteKingUnderAttack() const;
-    bool isBlackKingUnderAttack() const;
-    bool isSquareUnderAttackByWhitePieces(const std::string&) const;
-    bool isSquareUnderAttackByBlackPieces(const std::string&) const;
-    bool canCastle(chessPiece*, const std::string&, const std::string&);
+    bool isWhiteKingUnderAttack() const {
+        return isKingUnderAttack<chessPiece::COLOR::WHITE>();
+    }
+    bool isBlackKingUnderAttack() const {
+        return isKingUnderAttack<chessPiece::COLOR::BLACK>();
+    }
+    bool isSquareUnderAttackByWhitePieces(const std::string& position) const {
+        return isSquareUnderAttackBy<chessPiece::COLOR::WHITE>(squareIndex(position));
+    }
+    bool isSquareUnderAttackByBlackPieces(const std::string& position) const {
+        return isSquareUnderAttackBy<chessPiece::COLOR::BLACK>(squareIndex(position));
+    }
+    bool canCastle(chessPiece*, const std::string&);
 
     bool isValidMove(const std::string&, const std::string&);
-    std::vector<chessPiece*> getWhiteKingAttackers();
-    std::vector<chessPiece*> getBlackKingAttackers();
+    std::vector<chessPiece*> getWhiteKingAttackers() const {
+        return getKingAttackers<chessPiece::COLOR::WHITE>();
+    }
+    std::vector<chessPiece*> getBlackKingAttackers() const {
+        return getKingAttackers<chessPiece::COLOR::BLACK>();
+    }
 
-    bool whiteKingCheckCanBeEliminated();
-    bool blackKingCheckCanBeEliminated();
+    bool whiteKingCheckCanBeEliminated() {
+        return kingCheckCanBeEliminated<chessPiece::COLOR::WHITE>();
+    }
+    bool blackKingCheckCanBeEliminated() {
+        return kingCheckCanBeEliminated<chessPiece::COLOR::BLACK>();
+    }
 
-    bool isWhiteCheckMated();
-    bool isBlackCheckMated();
-    bool isWhiteStalemate();
-    bool isBlackStalemate();
+    bool isWhiteCheckMated() {
+        return isKingUnderAttack<chessPiece::COLOR::WHITE>() && !kingCheckCanBeEliminated<chessPiece::COLOR::WHITE>();
+    }
+    bool isBlackCheckMated() {
+        return isKingUnderAttack<chessPiece::COLOR::BLACK>() && !kingCheckCanBeEliminated<chessPiece::COLOR::BLACK>();
+    }
+    bool isWhiteStalemate() {
+        return isStalemate<chessPiece::COLOR::WHITE>();
+    }
+    bool isBlackStalemate() {
+        return isStalemate<chessPiece::COLOR::BLACK>();
+    }
     bool isRepetition() const;
     bool isWhiteMoved(const std::string&);
     bool isBlackMoved(const std::string&);
+    bool isValidInput(const std::string&, const std::string&) const;
+    bool makeMove(chessPiece::COLOR, const std::string&, const std::string&);
+    bool makeMove(chessPiece::COLOR, Move);
+    STATUS getStatus(chessPiece::COLOR);
+
+    chessPiece::COLOR getSideToMove() const {
+        return m_sideToMove;
+    }
+    std::uint8_t getCastlingRights() const;
+    int getEnPassantFile() const;
+    std::uint64_t getHash() const;
+
+    void setupPosition(const std::vector<PiecePlacement>&, chessPiece::COLOR, std::uint8_t castlingRights = 0);
+    Position getPosition() const;
+    void setPosition(const Position&);
+    int getHalfmoveClock() const {
+        return m_halfmoveClock;
+    }
+    int getFullmoveNumber() const {
+        return m_fullmoveNumber;
+    }
+    // piece counts by color and kind, see material.hpp
+    std::uint64_t getMaterialKey() const {
+        return m_materialKey;
+    }
+    void getLegalMoves(std::vector<Move>&);
 
     void move(const std::string&, const std::string&);
     void performCastle(const std::string&, const std::string&);
     void performPawnCapture(const std::string&, const std::string&);
     void performPromotion(chessPiece*&);
+    void recordMove(Move, bool irreversible);
+    chessPiece* createPiece(chessPiece::PIECE, chessPiece::COLOR, const std::string&);
+    void deletePieces();
 
-    std::vector<std::pair<std::string, std::string>>& getMoveDB() {
+    std::vector<Move>& getMoveDB() {
         return m_moveDB;
     }
 
-    std::pair<std::string, std::string> getLastMove() const {
-        return m_moveDB[m_moveDB.size() - 1];
+    // null move if nothing is played yet
+    Move getLastMove() const {
+        return m_moveDB.empty() ? Move() : m_moveDB.back();
     }
 
     void resetFlags() {
@@ -83,11 +155,45 @@ public:
         m_activatePromotion = false;
     }
 
+private:
+    // The rules are written once for both sides: Color is the side whose king, pieces or move is checked,
+    // the pieces of the side and of the opponent are chosen at compile time.
+    template <chessPiece::COLOR Color>
+    static constexpr chessPiece::COLOR opponentOf = (Color == chessPiece::COLOR::WHITE) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+
+    template <chessPiece::COLOR Color>
+    const std::vector<chessPiece*>& piecesOf() const {
+        if constexpr (Color == chessPiece::COLOR::WHITE) return whitePieces;
+        else return blackPieces;
+    }
+
+    template <chessPiece::COLOR Color> bool isKingUnderAttack() const;
+    template <chessPiece::COLOR Color> bool isSquareUnderAttackBy(int square) const;
+    template <chessPiece::COLOR Color> std::vector<chessPiece*> getKingAttackers() const;
+    template <chessPiece::COLOR Color> std::vector<chessPiece*> findKingAttackers() const;
+    template <chessPiece::COLOR Color> void updateCheckers(std::initializer_list<const chessPiece*> arrived, std::initializer_list<int> vacated);
+    void updateCheckers(std::initializer_list<const chessPiece*> arrived, std::initializer_list<int> vacated);
+    void findCheckers();
+    void findMaterialKey();
+    void removeMaterial(const chessPiece* p_captured) {
+        m_materialKey -= material::unit(p_captured->getColor(), p_captured->getPiece(), squareIndex(p_captured->getPosition()));
+    }
+    template <chessPiece::COLOR Color> bool kingCheckCanBeEliminated();
+    template <chessPiece::COLOR Color> bool isStalemate();
+    template <chessPiece::COLOR Color> bool canCastleTo(const King*, const std::string& destination);
+    template <chessPiece::COLOR Color> bool isKingDestinationSafe(int destination) const;
+    template <chessPiece::COLOR Color> bool isKingSafeAfterMove(int source, int destination, const chessPiece* p_captured, int vacated = -1) const;
+
 public:
     chessBoard* m_chessBoard = nullptr;
     std::vector<chessPiece*> whitePieces;
     std::vector<chessPiece*> blackPieces;
-    std::vector<std::pair<std::string, std::string>> m_moveDB;
+    std::vector<Move> m_moveDB;
+    chessPiece::COLOR m_sideToMove = chessPiece::COLOR::WHITE;
+    int m_halfmoveClock = 0;
+    int m_fullmoveNumber = 1;
+    SquareList m_checkers; // squares of the pieces giving check to the side to move, kept by move()
+    std::uint64_t m_materialKey = 0; // kept by move() and performPromotion()
 
     bool m_activateCastling = false;
     bool m_activatePawnCapturing = false;
@@ -99,9 +205,15 @@ Chess::Chess() {
     m_chessBoard = new chessBoard();
     setWhitePieces();
     setBlackPieces();  
+    findMaterialKey();
 }
 
 Chess::~Chess() {
+    deletePieces();
+    delete m_chessBoard;
+}
+
+void Chess::deletePieces() {
     for (auto& piece : whitePieces) {
         delete piece;
     }
@@ -109,8 +221,65 @@ Chess::~Chess() {
     for (auto& piece : blackPieces) {
         delete piece;
     }
+    whitePieces.clear();
+    blackPieces.clear();
+}
 
-    delete m_chessBoard;
+chessPiece* Chess::createPiece(chessPiece::PIECE piece, chessPiece::COLOR color, const std::string& position) {
+    switch (piece) {
+        case chessPiece::PIECE::KING: return new King(color, position, m_chessBoard);
+        case chessPiece::PIECE::QUEEN: return new Queen(color, position, m_chessBoard);
+        case chessPiece::PIECE::BISHOP: return new Bishop(color, position, m_chessBoard);
+        case chessPiece::PIECE::ROOK: return new Rook(color, position, m_chessBoard);
+        case chessPiece::PIECE::KNIGHT: return new Knight(color, position, m_chessBoard);
+        case chessPiece::PIECE::PAWN: return new Pawn(color, position, m_chessBoard);
+        default: throw std::logic_error("Unknown piece\n");
+    }
+}
+
+// replaces the position, the move history is cleared.
+// Kings are placed first, as the rest of the class expects them at index 0.
+// Pawns on their initial row keep the first move, kings and rooks only if the castling rights say so.
+void Chess::setupPosition(const std::vector<PiecePlacement>& placements, chessPiece::COLOR sideToMove, std::uint8_t castlingRights) {
+    deletePieces();
+    for (auto& square : m_chessBoard->getBoardMap()) {
+        *square.second = '_';
+    }
+    m_moveDB.clear();
+    resetFlags();
+    m_sideToMove = sideToMove;
+    m_halfmoveClock = 0;
+    m_fullmoveNumber = 1;
+
+    for (bool kings : {true, false}) {
+        for (const PiecePlacement& placement : placements) {
+            if ((placement.piece == chessPiece::PIECE::KING) != kings) continue;
+            std::string position = squareName(placement.square);
+            chessPiece* p_piece = createPiece(placement.piece, placement.color, position);
+            bool white = placement.color == chessPiece::COLOR::WHITE;
+            (white ? whitePieces : blackPieces).push_back(p_piece);
+            if (placement.piece == chessPiece::PIECE::PAWN) {
+                p_piece->setFirstMove(position[1] == (white ? '2' : '7'));
+            } else if (placement.piece == chessPiece::PIECE::KING) {
+                std::uint8_t rights = white ? (zobrist::WHITE_KING_SIDE | zobrist::WHITE_QUEEN_SIDE) :
+                                              (zobrist::BLACK_KING_SIDE | zobrist::BLACK_QUEEN_SIDE);
+                p_piece->setFirstMove(position == (white ? "e1" : "e8") && (castlingRights & rights));
+            } else if (placement.piece == chessPiece::PIECE::ROOK) {
+                std::uint8_t right = 0;
+                if (position == "h1") right = zobrist::WHITE_KING_SIDE;
+                if (position == "a1") right = zobrist::WHITE_QUEEN_SIDE;
+                if (position == "h8") right = zobrist::BLACK_KING_SIDE;
+                if (position == "a8") right = zobrist::BLACK_QUEEN_SIDE;
+                p_piece->setFirstMove(castlingRights & right);
+            }
+        }
+    }
+    if (whitePieces.empty() || blackPieces.empty() ||
+        whitePieces[0]->getPiece() != chessPiece::PIECE::KING || blackPieces[0]->getPiece() != chessPiece::PIECE::KING) {
+        throw std::logic_error("Position without a king\n");
+    }
+    findCheckers();
+    findMaterialKey();
 }
 
 void Chess::setWhitePieces() {
@@ -188,6 +357,7 @@ void Chess::showBoard() const {
 }
 
 chessPiece* Chess::getPieceFromPosition(const std::string& position) const {
+    CHESS_INSTRUMENT(GET_PIECE_FROM_POSITION);
     for (chessPiece* p_chessPiece : whitePieces) {
         if (p_chessPiece->getPosition() == position) {
             return p_chessPiece;
@@ -201,50 +371,26 @@ chessPiece* Chess::getPieceFromPosition(const std::string& position) const {
     return nullptr;
 }
 
-bool Chess::isWhiteKingUnderAttack() const {
-    std::string wKingPos = whitePieces[0]->getPosition(); // index call is safe
-    auto iter = blackPieces.begin(); ++iter; // skipping king, as it can't attack another king
-    for (; iter != blackPieces.end(); ++iter) {
-        for (std::string pos : (*iter)->getAttackingSquares()) {
-            if (pos == wKingPos) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-bool Chess::isBlackKingUnderAttack() const {
-    std::string bKingPos = blackPieces[0]->getPosition();
-    auto iter = whitePieces.begin(); ++iter;
-    for (; iter != whitePieces.end(); ++iter) {
-        for (std::string pos : (*iter)->getAttackingSquares()) {
-            if (pos == bKingPos) {
-                return true;
-            }
+// the side to move reads the checkers kept by move(), the other side is scanned
+template <chessPiece::COLOR Color>
+bool Chess::isKingUnderAttack() const {
+    if (Color == m_sideToMove) return !m_checkers.empty();
+    int kingSquare = squareIndex(piecesOf<Color>()[0]->getPosition()); // index call is safe
+    const auto& attackers = piecesOf<opponentOf<Color>>();
+    auto iter = attackers.begin(); ++iter; // skipping king, as it can't attack another king
+    for (; iter != attackers.end(); ++iter) {
+        if ((*iter)->attacks(kingSquare)) {
+            return true;
         }
     }
     return false;
 }
 
-bool Chess::isSquareUnderAttackByWhitePieces(const std::string& position) const {
-    auto iter = whitePieces.begin();
-    for (; iter != whitePieces.end(); ++iter) {
-        for (std::string pos : (*iter)->getAttackingSquares()) {
-            if (pos == position) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-bool Chess::isSquareUnderAttackByBlackPieces(const std::string& position) const {
-    auto iter = blackPieces.begin();
-    for (; iter != blackPieces.end(); ++iter) {
-        for (std::string pos : (*iter)->getAttackingSquares()) {
-            if (pos == position) {
-                return true;
-            }
+template <chessPiece::COLOR Color>
+bool Chess::isSquareUnderAttackBy(int square) const {
+    for (chessPiece* p_piece : piecesOf<Color>()) {
+        if (p_piece->attacks(square)) {
+            return true;
         }
     }
     return false;
@@ -252,107 +398,84 @@ bool Chess::isSquareUnderAttackByBlackPieces(const std::string& position) const
 
 // can castle if: 1: no check at the moment, 2: king is on it's first move,
 //                3: rook is on the first move, 4: no squares between king and the rook are occupied or under attack
-bool Chess::canCastle(chessPiece* p_chessPiece, const std::string& source, const std::string& destination) {
+bool Chess::canCastle(chessPiece* p_chessPiece, const std::string& destination) {
     // dynamic cast is safe as piece type is already checked
     King* p_king = dynamic_cast<King*>(p_chessPiece);
     if (!p_king) return false;
     if (p_king->getColor() == chessPiece::COLOR::WHITE) {
-        if (isWhiteKingUnderAttack() || !p_king->isFirstMove()) {
-            return false;
-        }
-        if (destination == "g1") {
-            if (m_chessBoard->isSquareOccupied("f1") || m_chessBoard->isSquareOccupied("g1") ||
-                isSquareUnderAttackByBlackPieces("f1") || isSquareUnderAttackByBlackPieces("g1") ) {
-                return false;
-            }
-            chessPiece* p_destPiece = getPieceFromPosition("h1");
-            if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_chessPiece->isFirstMove()) {
-                return true;
-            }
-        }
+        return canCastleTo<chessPiece::COLOR::WHITE>(p_king, destination);
+    }
+    return canCastleTo<chessPiece::COLOR::BLACK>(p_king, destination);
+}
 
-        if (destination == "c1") {
-            if (m_chessBoard->isSquareOccupied("d1") || m_chessBoard->isSquareOccupied("c1") || 
-                m_chessBoard->isSquareOccupied("b1") || isSquareUnderAttackByBlackPieces("d1") || 
-                isSquareUnderAttackByBlackPieces("c1")) {
-                    return false;
-            }
-            chessPiece* p_destPiece = getPieceFromPosition("a1");
-            if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_chessPiece->isFirstMove()) {
-                return true;
-            }
-        }
+template <chessPiece::COLOR Color>
+bool Chess::canCastleTo(const King* p_king, const std::string& destination) {
+    constexpr char rank = (Color == chessPiece::COLOR::WHITE) ? '1' : '8';
+    if (isKingUnderAttack<Color>() || !p_king->isFirstMove()) {
+        return false;
     }
-    
-    if (p_chessPiece->getColor() == chessPiece::COLOR::BLACK) {
-        if (isBlackKingUnderAttack() || !p_king->isFirstMove()) {
+    if (destination == std::string{'g', rank}) {
+        if (m_chessBoard->isSquareOccupied({'f', rank}) || m_chessBoard->isSquareOccupied({'g', rank}) ||
+            isSquareUnderAttackBy<opponentOf<Color>>(squareIndex({'f', rank})) ||
+            isSquareUnderAttackBy<opponentOf<Color>>(squareIndex({'g', rank}))) {
             return false;
         }
-        if (destination == "g8") {
-            if (m_chessBoard->isSquareOccupied("f8") || m_chessBoard->isSquareOccupied("g8") ||
-                isSquareUnderAttackByWhitePieces("f8") || isSquareUnderAttackByWhitePieces("g8")) {
-                return false;
-            }
-            chessPiece* p_destPiece = getPieceFromPosition("h8");
-            if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_chessPiece->isFirstMove()) {
-                return true;
-            }
+        chessPiece* p_destPiece = getPieceFromPosition({'h', rank});
+        if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_destPiece->isFirstMove()) {
+            return true;
         }
+    }
 
-        if (destination == "c8") {
-            if (m_chessBoard->isSquareOccupied("d8") || m_chessBoard->isSquareOccupied("c8") || 
-                m_chessBoard->isSquareOccupied("b8") || isSquareUnderAttackByWhitePieces("d8") || 
-                isSquareUnderAttackByWhitePieces("c8")) {
-                    return false;
-            }
-            chessPiece* p_destPiece = getPieceFromPosition("a8");
-            if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_chessPiece->isFirstMove()) {
-                return true;
-            }
+    if (destination == std::string{'c', rank}) {
+        if (m_chessBoard->isSquareOccupied({'d', rank}) || m_chessBoard->isSquareOccupied({'c', rank}) ||
+            m_chessBoard->isSquareOccupied({'b', rank}) || isSquareUnderAttackBy<opponentOf<Color>>(squareIndex({'d', rank})) ||
+            isSquareUnderAttackBy<opponentOf<Color>>(squareIndex({'c', rank}))) {
+                return false;
+        }
+        chessPiece* p_destPiece = getPieceFromPosition({'a', rank});
+        if (p_destPiece && p_destPiece->getPiece() == chessPiece::PIECE::ROOK && p_destPiece->isFirstMove()) {
+            return true;
         }
     }
-
     return false;
 }
 
 // move validation, more comments in each line
 bool Chess::isValidMove(const std::string& source, const std::string& destination) {
+    CHESS_INSTRUMENT(IS_VALID_MOVE);
+    CHESS_ALLOC_SCOPE(IS_VALID_MOVE);
     chessPiece* p_chessPiece = getPieceFromPosition(source);
     if (!p_chessPiece) return false;
     if (!p_chessPiece->isValidMove(source, destination)) { // move validation used from chessPiece for game rule check
         // if the move is not valid for king, check for castling
         if (p_chessPiece->getPiece() == chessPiece::PIECE::KING) {
-            m_activateCastling = canCastle(p_chessPiece, source, destination);
+            m_activateCastling = canCastle(p_chessPiece, destination);
             return m_activateCastling;
         }
         // if the move is not valid for a pawn, we check for capturing and enPassant moves.
         if (p_chessPiece->getPiece() == chessPiece::PIECE::PAWN) {
             // if the destination can be found in attackingSquares
-            std::vector<std::string> pawnAttackingSquares = p_chessPiece->getAttackingSquares();
-            if (std::find(pawnAttackingSquares.begin(), pawnAttackingSquares.end(), destination) == pawnAttackingSquares.end()) return false;
-            if (p_chessPiece->getColor() == chessPiece::COLOR::WHITE) {
-                for (chessPiece* p_piece : blackPieces) {
-                    if (p_piece->getPosition() == destination) {
-                        m_activatePawnCapturing = true;
-                    }
-                }
-            } else if (p_chessPiece->getColor() == chessPiece::COLOR::BLACK) {
-                for (chessPiece* p_piece : whitePieces) {
-                    if (p_piece->getPosition() == destination) {
-                        m_activatePawnCapturing = true;
-                    }
+            if (!p_chessPiece->attacks(squareIndex(destination))) return false;
+            const auto& opponents = (p_chessPiece->getColor() == chessPiece::COLOR::WHITE) ? blackPieces : whitePieces;
+            for (chessPiece* p_piece : opponents) {
+                if (p_piece->getPosition() == destination) {
+                    m_activatePawnCapturing = true;
                 }
             }
             // if the pawn can neither move nor capture, check en passant
             if (!m_activatePawnCapturing) {
-                std::pair<std::string, std::string> lastMove = getLastMove(); // we must have an exact last move for enPassant
-                chessPiece* lastMover = getPieceFromPosition(lastMove.second);
+                Move lastMove = getLastMove(); // we must have an exact last move for enPassant
+                if (lastMove.isNull()) return false;
+                std::string lastSource = lastMove.source();
+                std::string lastDestination = lastMove.destination();
+                chessPiece* lastMover = getPieceFromPosition(lastDestination);
                 Pawn* p_pawn = dynamic_cast<Pawn*>(lastMover);
                 // if the the last move performer is not a pawn or is not a 2 move forward,
-                // or not near the pawn diagonale => there is no en passant
-                if (!p_pawn || std::abs(lastMove.first[1] - lastMove.second[1]) != 2 || 
-                    std::abs(p_chessPiece->getPosition()[0] - lastMove.second[0]) != 1 ||
-                    (p_chessPiece->getPosition()[1] != lastMove.second[1])) return false; // in enPassant case the row is the same for 2 pawns
+                // or not near the pawn diagonale, or the capture is not towards it => there is no en passant
+                if (!p_pawn || std::abs(lastSource[1] - lastDestination[1]) != 2 || 
+                    std::abs(p_chessPiece->getPosition()[0] - lastDestination[0]) != 1 ||
+                    (p_chessPiece->getPosition()[1] != lastDestination[1]) || // in enPassant case the row is the same for 2 pawns
+                    destination[0] != lastDestination[0]) return false;
                 m_enPassant = true;
             }
         }
@@ -362,36 +485,13 @@ bool Chess::isValidMove(const std::string& source, const std::string& destinatio
     if (p_chessPiece->getPiece() == chessPiece::PIECE::PAWN && p_chessPiece->isValidMove(source, destination) && m_chessBoard->isSquareOccupied(destination)) {
         return false;
     }
+    const bool white = p_chessPiece->getColor() == chessPiece::COLOR::WHITE;
+    const int sourceSquare = squareIndex(source), destinationSquare = squareIndex(destination);
     // if the piece is the king then the destination should not be under attack.
     if (p_chessPiece->getPiece() == chessPiece::PIECE::KING) {
-        if (p_chessPiece->getColor() == chessPiece::COLOR::WHITE) {
-            if (isSquareUnderAttackByBlackPieces(destination)) {
-                return false;
-            }
-            auto whiteKingAttackers = getWhiteKingAttackers();
-            // there can be at most 2 attackers on the king, and if they do attack at that moment, 
-            // that means that the next position for the king could be under attack too. (i.e. if the rook from h1 attacks e1 king, then king cannot go to d1)
-            // the reason for the additional check with getAttackingPath() function is that
-            // getAttackingSquares can't see the squares after the king, which is NOT INcorrect
-            for (chessPiece* p_blackAttacker : whiteKingAttackers) {
-                for (std::string possibleAttackedSquare : p_blackAttacker->getAttackingPath(destination)) {
-                    if (possibleAttackedSquare == destination) {
-                        return false;
-                    }
-                }
-            }
-        } else {
-            if (isSquareUnderAttackByWhitePieces(destination)) {
-                return false;
-            }
-            auto blackKingAttackers = getBlackKingAttackers();
-            for (chessPiece* p_whiteAttacker : blackKingAttackers) {
-                for (std::string possibleAttackedSquare : p_whiteAttacker->getAttackingPath(destination)) {
-                    if (possibleAttackedSquare == destination) {
-                        return false;
-                    }
-                }
-            }
+        if (white ? !isKingDestinationSafe<chessPiece::COLOR::WHITE>(destinationSquare)
+                  : !isKingDestinationSafe<chessPiece::COLOR::BLACK>(destinationSquare)) {
+            return false;
         }
     }
     // check if the destination piece(if exists) is with the same color
@@ -404,188 +504,149 @@ bool Chess::isValidMove(const std::string& source, const std::string& destinatio
         }
     }
 
-    // Check all black pieces which can attack the white king after white's move.
-    // We skip the black piece from destination, as it can be taken, and there is no need to check it's attacking performance.
-    // We consider queen, rook, and bishop, as moving a white piece can open a check for these 3 guys only.
-    // Iterating over attacking path(to the king) of each mentioned piece,
-    // we check if the entire path is not occupied, and therefore the check can be opened after white's move
-    // Also we add a check for the case when moving a white piece can close the check, so if 
-    // the destination is on the path, it's ok to move => so the occupation check added for the destination
-    // the same is done for the black piece movement.
-    if (p_chessPiece->getColor() == chessPiece::COLOR::WHITE) {
-        std::string wKingPos = whitePieces[0]->getPosition();
-        // if the moving piece is the king, then there is no need to check it's source position
-        // for a possible check opening. Instead we should remove the wKingPos check 
-        // and reassign it to the destination, as it is the square where the king will be placed.
-        if (wKingPos == source) wKingPos = destination;
-        for (chessPiece* blackPiece : blackPieces) {
-            chessPiece::PIECE blackPieceType = blackPiece->getPiece();
-            if (blackPiece != p_pieceFromDestination && (blackPieceType == chessPiece::PIECE::QUEEN ||
-                                                         blackPieceType == chessPiece::PIECE::ROOK ||
-                                                         blackPieceType == chessPiece::PIECE::BISHOP)) {
-                for (std::string squareOnPath : blackPiece->getAttackingPath(wKingPos)) {
-                    if (squareOnPath == blackPiece->getPosition() || // skip own square
-                        (wKingPos != destination && source == squareOnPath)) continue; // if the moved piece is not the king and the source position is not the square on path, as the piece is not under that position any more
-                    if ((m_chessBoard->isSquareOccupied(squareOnPath) || squareOnPath == destination) && squareOnPath != wKingPos) { // if the path can be closed or is already closed for the check and that square is not the king's square
-                        break;
-                    }
-                    if (squareOnPath == wKingPos) {
-                        return false; // if any black piece after white's piece move can attack white's king => the move is not valid
-                    }
-                }
-            } else if (blackPiece != p_pieceFromDestination) { // case for knights and pawns
-                for (std::string attackedSquare : blackPiece->getAttackingSquares()) {
-                    if (attackedSquare == blackPiece->getPosition()) continue;
-                    if (attackedSquare == wKingPos) return false;
-                }
-            }
+    // en passant takes the pawn beside the destination, its square is left empty too (both pawns may leave the king's rank)
+    const chessPiece* p_captured = p_pieceFromDestination;
+    int vacated = -1;
+    if (m_enPassant) {
+        vacated = getLastMove().to();
+        p_captured = getPieceFromPosition(squareName(vacated));
+    }
+    return white ? isKingSafeAfterMove<chessPiece::COLOR::WHITE>(sourceSquare, destinationSquare, p_captured, vacated)
+                 : isKingSafeAfterMove<chessPiece::COLOR::BLACK>(sourceSquare, destinationSquare, p_captured, vacated);
+}
+
+// the king of Color moves to the destination: it must not be attacked there
+template <chessPiece::COLOR Color>
+bool Chess::isKingDestinationSafe(int destination) const {
+    if (isSquareUnderAttackBy<opponentOf<Color>>(destination)) {
+        return false;
+    }
+    // there can be at most 2 attackers on the king, and if they do attack at that moment, 
+    // that means that the next position for the king could be under attack too. (i.e. if the rook from h1 attacks e1 king, then king cannot go to d1)
+    // the reason for the additional check with the attacking path is that
+    // the attacking squares can't see the squares after the king, which is NOT INcorrect
+    SquareList path;
+    for (chessPiece* p_attacker : getKingAttackers<Color>()) {
+        path.clear();
+        p_attacker->collectAttackingPath(destination, path);
+        if (path.contains(destination)) {
+            return false;
         }
-    } else if (p_chessPiece->getColor() == chessPiece::COLOR::BLACK) {
-        std::string bKingPos = blackPieces[0]->getPosition();
-        if (bKingPos == source) bKingPos = destination;
-        for (chessPiece* whitePiece : whitePieces) {
-            chessPiece::PIECE whitePieceType = whitePiece->getPiece();
-            if (whitePiece != p_pieceFromDestination && (whitePieceType == chessPiece::PIECE::QUEEN ||
-                                                         whitePieceType == chessPiece::PIECE::ROOK) ||
-                                                         whitePieceType == chessPiece::PIECE::BISHOP) {
-                for (std::string squareOnPath : whitePiece->getAttackingPath(bKingPos)) {
-                    if (squareOnPath == whitePiece->getPosition() || 
-                        (bKingPos != destination && source == squareOnPath)) continue;
-                    if ((m_chessBoard->isSquareOccupied(squareOnPath) || squareOnPath == destination) && squareOnPath != bKingPos) {
-                        break;
-                    }
-                    if (squareOnPath == bKingPos) {
-                        return false;
-                    }
+    }
+    return true;
+}
+
+// Check all opponent pieces which can attack the king of Color after the move.
+// We skip the opponent piece from destination, as it can be taken, and there is no need to check it's attacking performance.
+// For en passant the taken pawn is p_captured and its square is the vacated one.
+// We consider queen, rook, and bishop, as moving a piece can open a check for these 3 guys only.
+// Iterating over attacking path(to the king) of each mentioned piece,
+// we check if the entire path is not occupied, and therefore the check can be opened after the move
+// Also we add a check for the case when moving a piece can close the check, so if 
+// the destination is on the path, it's ok to move => so the occupation check added for the destination
+template <chessPiece::COLOR Color>
+bool Chess::isKingSafeAfterMove(int source, int destination, const chessPiece* p_captured, int vacated) const {
+    int kingPos = squareIndex(piecesOf<Color>()[0]->getPosition());
+    // if the moving piece is the king, then there is no need to check it's source position
+    // for a possible check opening. Instead we should remove the kingPos check 
+    // and reassign it to the destination, as it is the square where the king will be placed.
+    if (kingPos == source) kingPos = destination;
+    SquareList squares;
+    for (chessPiece* p_opponent : piecesOf<opponentOf<Color>>()) {
+        if (p_opponent == p_captured) continue;
+        chessPiece::PIECE type = p_opponent->getPiece();
+        if (type == chessPiece::PIECE::QUEEN || type == chessPiece::PIECE::ROOK || type == chessPiece::PIECE::BISHOP) {
+            squares.clear();
+            p_opponent->collectAttackingPath(kingPos, squares);
+            const int ownSquare = squareIndex(p_opponent->getPosition());
+            for (int squareOnPath : squares) {
+                if (squareOnPath == ownSquare || // skip own square
+                    (kingPos != destination && source == squareOnPath) || // if the moved piece is not the king and the source position is not the square on path, as the piece is not under that position any more
+                    squareOnPath == vacated) continue; // the pawn taken en passant
+                if ((m_chessBoard->isSquareOccupied(squareOnPath) || squareOnPath == destination) && squareOnPath != kingPos) { // if the path can be closed or is already closed for the check and that square is not the king's square
+                    break;
                 }
-            } else if (whitePiece != p_pieceFromDestination) {
-                for (std::string attackedSquare : whitePiece->getAttackingSquares()) {
-                    if (attackedSquare == whitePiece->getPosition()) continue;
-                    if (attackedSquare == bKingPos) return false;
+                if (squareOnPath == kingPos) {
+                    return false; // if any opponent piece after the move can attack the king => the move is not valid
                 }
             }
+        } else if (p_opponent->attacks(kingPos)) { // case for knights, pawns and the king
+            return false;
         }
     }
-
     return true;
 }
 
-std::vector<chessPiece*> Chess::getWhiteKingAttackers() {
-    std::vector<chessPiece*> whiteKingAttackers;
-    chessPiece* wKing = whitePieces[0];
-    std::string wKingPos = wKing->getPosition();
-    auto iter = blackPieces.begin(); ++iter; // skip the king, as king cannot attack the king
-    for (; iter != blackPieces.end(); ++iter) { 
-        for (std::string s : (*iter)->getAttackingSquares()) {
-            if (s == wKingPos) { 
-                whiteKingAttackers.push_back(*(iter));
-                break; // if we found an attacker then there is no need to look at another attacking squares of the same piece
-            }
-        }
+template <chessPiece::COLOR Color>
+std::vector<chessPiece*> Chess::getKingAttackers() const {
+    if (Color != m_sideToMove) return findKingAttackers<Color>();
+    std::vector<chessPiece*> kingAttackers;
+    for (int square : m_checkers) {
+        kingAttackers.push_back(getPieceFromPosition(squareName(square)));
     }
-    return whiteKingAttackers;
+    return kingAttackers;
 }
 
-std::vector<chessPiece*> Chess::getBlackKingAttackers() {
-    std::vector<chessPiece*> blackKingAttackers;
-    chessPiece* bKing = blackPieces[0];
-    std::string bKingPos = bKing->getPosition();
-    auto iter = whitePieces.begin(); ++iter;
-    for (; iter != whitePieces.end(); ++iter) {
-        for (std::string s : (*iter)->getAttackingSquares()) {
-            if (s == bKingPos) { 
-                blackKingAttackers.push_back(*(iter));
-                break;
-            }
+// every opponent piece is asked if it attacks the king
+template <chessPiece::COLOR Color>
+std::vector<chessPiece*> Chess::findKingAttackers() const {
+    std::vector<chessPiece*> kingAttackers;
+    int kingSquare = squareIndex(piecesOf<Color>()[0]->getPosition());
+    const auto& attackers = piecesOf<opponentOf<Color>>();
+    auto iter = attackers.begin(); ++iter; // skip the king, as king cannot attack the king
+    for (; iter != attackers.end(); ++iter) { 
+        if ((*iter)->attacks(kingSquare)) { 
+            kingAttackers.push_back(*(iter));
         }
     }
-    return blackKingAttackers;
+    return kingAttackers;
 }
 
 // if the king is under attack, check if the king check can be terminated
 // this function call is useless if the king is not under attack
-bool Chess::whiteKingCheckCanBeEliminated() {
-    chessPiece* wKing = whitePieces[0];
-    std::string wkingPos = wKing->getPosition();
+template <chessPiece::COLOR Color>
+bool Chess::kingCheckCanBeEliminated() {
+    const auto& pieces = piecesOf<Color>();
+    chessPiece* king = pieces[0];
+    std::string kingPos = king->getPosition();
+    SquareList squares;
+    king->collectAttackingSquares(squares);
     // check if the king can run away
-    for (std::string pos : wKing->getAttackingSquares()) {
-        if (isValidMove(wkingPos, pos)) {
+    for (int square : squares) {
+        if (isValidMove(kingPos, squareName(square))) {
             return true;
         }
     }
 
-    const auto& whiteKingAttackers = getWhiteKingAttackers();
-    if (whiteKingAttackers.empty()) throw std::logic_error("Invalid function use"); // there were no attackers.
-    if (whiteKingAttackers.size() > 1) { // if there is a double check => no way to eliminate the attack. And as the king's moves are already checked return false
+    const auto& kingAttackers = getKingAttackers<Color>();
+    if (kingAttackers.empty()) throw std::logic_error("Invalid function use"); // there were no attackers.
+    if (kingAttackers.size() > 1) { // if there is a double check => no way to eliminate the attack. And as the king's moves are already checked return false
         return false;
     }
 
-    chessPiece* attacker = whiteKingAttackers[0];
-    std::string attackerPosition = attacker->getPosition();
+    chessPiece* attacker = kingAttackers[0];
+    int attackerPosition = squareIndex(attacker->getPosition());
     // getting attacking path of the attacker, as the check can be eliminated by covering the check path, which can be performed only for bishop, rook and queen
     // or be captured if the king has no way to move
-    auto attackingPath = attacker->getAttackingPath(wkingPos);
-    attackingPath.pop_back(); // we remove the king's square for the upcoming check
+    SquareList attackingPath;
+    attacker->collectAttackingPath(squareIndex(kingPos), attackingPath);
+    if (!attackingPath.empty()) attackingPath.pop_back(); // we remove the king's square for the upcoming check, knights and pawns have no path
 
-    auto iter = whitePieces.begin(); ++iter;
-    for (; iter != whitePieces.end(); ++iter) {
-        auto attackingSquares = (*iter)->getAttackingSquares();
+    auto iter = pieces.begin(); ++iter;
+    for (; iter != pieces.end(); ++iter) {
+        squares.clear();
+        (*iter)->collectAttackingSquares(squares);
         if ((*iter)->getPiece() == chessPiece::PIECE::PAWN) {
-            Pawn* p_pawn = dynamic_cast<Pawn*>((*iter));
             // only pawn should be check for additional valid moves,
             // as the pawn can not only eat the attacker, but also make a move and block the attacking path
             // for all other pieces the valid moves are attacking squares, which is not true for the pawn
-            for (std::string s : p_pawn->getValidMovesWithoutAttack()) {
-                attackingSquares.push_back(s);
-            }
-        }
-        for (std::string s : attackingSquares) {
-            if (s == attackerPosition && isValidMove((*iter)->getPosition(), s)) { // attacker can be captured
-                return true;
-            }
-            if (!attackingPath.empty() && std::find(attackingPath.begin(), attackingPath.end(), s) != attackingPath.end() && isValidMove((*iter)->getPosition(), s)) { // attacking path can be closed
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-bool Chess::blackKingCheckCanBeEliminated() {
-    chessPiece* bKing = blackPieces[0];
-    std::string bkingPos = bKing->getPosition();
-    for (std::string pos : bKing->getAttackingSquares()) {
-        if (isValidMove(bkingPos, pos)) {
-            return true;
-        }
-    }
-
-    const auto& blackKingAttackers = getBlackKingAttackers();
-    if (blackKingAttackers.empty()) throw std::logic_error("Invalid function use"); 
-    if (blackKingAttackers.size() > 1) {
-        return false;
-    }
-
-    chessPiece* attacker = blackKingAttackers[0];
-    std::string attackerPosition = attacker->getPosition();
-    auto attackingPath = attacker->getAttackingPath(bkingPos);
-    attackingPath.pop_back();
-
-    auto iter = blackPieces.begin(); ++iter;
-    for (; iter != blackPieces.end(); ++iter) {
-        auto attackingSquares = (*iter)->getAttackingSquares();
-        if ((*iter)->getPiece() == chessPiece::PIECE::PAWN) {
-            Pawn* p_pawn = dynamic_cast<Pawn*>((*iter));
-            for (std::string s : p_pawn->getValidMovesWithoutAttack()) {
-                attackingSquares.push_back(s);
-            }
+            static_cast<Pawn*>(*iter)->collectPushes(squares);
         }
-        for (std::string s : attackingSquares) {
-            if (s == attackerPosition && isValidMove((*iter)->getPosition(), s)) {
+        for (int s : squares) {
+            if (s == attackerPosition && isValidMove((*iter)->getPosition(), squareName(s))) { // attacker can be captured
                 return true;
             }
-            if (!attackingPath.empty() && std::find(attackingPath.begin(), attackingPath.end(), s) != attackingPath.end() && isValidMove((*iter)->getPosition(), s)) {
+            if (attackingPath.contains(s) && isValidMove((*iter)->getPosition(), squareName(s))) { // attacking path can be closed
                 return true;
             }
         }
@@ -594,14 +655,6 @@ bool Chess::blackKingCheckCanBeEliminated() {
     return false;
 }
 
-bool Chess::isWhiteCheckMated() {
-    return (isWhiteKingUnderAttack() && !whiteKingCheckCanBeEliminated());
-}
-
-bool Chess::isBlackCheckMated() {
-    return (isBlackKingUnderAttack() && !blackKingCheckCanBeEliminated());
-}
-
 void Chess::performCastle(const std::string& source, const std::string& destination) {
     chessPiece* p_chessPiece = getPieceFromPosition(source); // guarantee that this function will be called after Piece type check
     if (p_chessPiece->getColor() == chessPiece::COLOR::WHITE) {
@@ -638,22 +691,25 @@ void Chess::performCastle(const std::string& source, const std::string& destinat
 void Chess::performPawnCapture(const std::string& source, const std::string& destination) {
     chessPiece* p_chessPiece = getPieceFromPosition(source);
     if (m_enPassant) {
-        std::pair<std::string, std::string> lastMove = getLastMove();
-        chessPiece* lastMover = getPieceFromPosition(lastMove.second);
+        Move lastMove = getLastMove();
+        std::string lastSource = lastMove.source();
+        std::string lastDestination = lastMove.destination();
+        chessPiece* lastMover = getPieceFromPosition(lastDestination);
+        removeMaterial(lastMover);
         std::string destSquare; 
-        destSquare.push_back(lastMove.second[0]);
-        destSquare.push_back( (lastMove.second[1] + lastMove.first[1]) / 2);
+        destSquare.push_back(lastDestination[0]);
+        destSquare.push_back( (lastDestination[1] + lastSource[1]) / 2);
         p_chessPiece->move(destSquare);
         auto iter1 = std::find(whitePieces.begin(), whitePieces.end(), lastMover);
         auto iter2 = std::find(blackPieces.begin(), blackPieces.end(), lastMover);
         if (iter1 != whitePieces.end()) {
             delete (*iter1);
             whitePieces.erase(iter1);
-            *m_chessBoard->getBoardMap()[lastMove.second] = '_'; // as the destination is not the position of the taken piece, we reset the taken pawn position to _
+            *m_chessBoard->getBoardMap()[lastDestination] = '_'; // as the destination is not the position of the taken piece, we reset the taken pawn position to _
         } else if (iter2 != blackPieces.end()) {
             delete (*iter2);
             blackPieces.erase(iter2);
-            *m_chessBoard->getBoardMap()[lastMove.second] = '_';
+            *m_chessBoard->getBoardMap()[lastDestination] = '_';
         } else {
             throw std::logic_error("En passant failure\n");
         }
@@ -662,6 +718,7 @@ void Chess::performPawnCapture(const std::string& source, const std::string& des
     }
     if (m_activatePawnCapturing) {
         chessPiece* p_pieceFromDestination = getPieceFromPosition(destination);
+        if (p_pieceFromDestination) removeMaterial(p_pieceFromDestination);
         p_chessPiece->move(destination);
         auto iter1 = std::find(whitePieces.begin(), whitePieces.end(), p_pieceFromDestination);
         auto iter2 = std::find(blackPieces.begin(), blackPieces.end(), p_pieceFromDestination);
@@ -688,6 +745,8 @@ void Chess::performPromotion(chessPiece*& p_chessPiece) {
             whitePieces.erase(iter);
             Queen* newQueen = new Queen(chessPiece::COLOR::WHITE, pos, m_chessBoard);
             whitePieces.push_back(newQueen);
+            p_chessPiece = newQueen;
+            m_materialKey = m_materialKey - material::unit(chessPiece::COLOR::WHITE, material::PAWN) + material::unit(chessPiece::COLOR::WHITE, material::QUEEN);
         } else {
             throw std::logic_error("Couldn't find the pawn to promote!\n");
         }
@@ -698,6 +757,8 @@ void Chess::performPromotion(chessPiece*& p_chessPiece) {
             blackPieces.erase(iter);
             Queen* newQueen = new Queen(chessPiece::COLOR::BLACK, pos, m_chessBoard);
             blackPieces.push_back(newQueen);
+            p_chessPiece = newQueen;
+            m_materialKey = m_materialKey - material::unit(chessPiece::COLOR::BLACK, material::PAWN) + material::unit(chessPiece::COLOR::BLACK, material::QUEEN);
         } else {
             throw std::logic_error("Couldn't find the pawn to promote!\n");
         }
@@ -705,27 +766,38 @@ void Chess::performPromotion(chessPiece*& p_chessPiece) {
 }
 
 // this function DOES NOT check for validation, responsibility is on the Game object
+// every performed move is recorded in moveDB with its type
 void Chess::move(const std::string& source, const std::string& destination) {
+    CHESS_ALLOC_SCOPE(MOVE);
     chessPiece* p_chessPiece = getPieceFromPosition(source);
-    if (p_chessPiece->getPiece() == chessPiece::PIECE::KING) {
-        if (m_activateCastling) {
-            performCastle(source, destination);
-            return;
-        }
+    Move::TYPE type = Move::TYPE::NORMAL;
+    const int from = squareIndex(source), to = squareIndex(destination);
+    if (p_chessPiece->getPiece() == chessPiece::PIECE::KING && m_activateCastling) {
+        performCastle(source, destination);
+        recordMove(Move(source, destination, Move::TYPE::CASTLING), false);
+        const bool kingSide = to > from;
+        updateCheckers({getPieceFromPosition(squareName(kingSide ? to - 1 : to + 1))}, {from, kingSide ? to + 1 : to - 2}); // the rook
+        return;
     }
     if (p_chessPiece->getPiece() == chessPiece::PIECE::PAWN) {
         if (destination[1] == '8' || destination[1] == '1') {
             m_activatePromotion = true;
+            type = Move::TYPE::PROMOTION;
         }
         if (m_activatePawnCapturing || m_enPassant) {
+            if (m_enPassant) type = Move::TYPE::EN_PASSANT;
+            const int captured = m_enPassant ? getLastMove().to() : to;
             performPawnCapture(source, destination);
             if (m_activatePromotion) performPromotion(p_chessPiece);
+            recordMove(Move(source, destination, type), true);
+            updateCheckers({p_chessPiece}, {from, captured});
             return;
         }
     }
     chessPiece* p_pieceFromDestination = getPieceFromPosition(destination);
     p_chessPiece->move(destination);
     if (p_pieceFromDestination) {
+        removeMaterial(p_pieceFromDestination);
         auto iter1 = std::find(whitePieces.begin(), whitePieces.end(), p_pieceFromDestination);
         auto iter2 = std::find(blackPieces.begin(), blackPieces.end(), p_pieceFromDestination);
         if (iter1 != whitePieces.end()) {
@@ -738,8 +810,202 @@ void Chess::move(const std::string& source, const std::string& destination) {
             throw std::logic_error("Piece capturing failure\n");
         }
     }
+    bool irreversible = p_pieceFromDestination || p_chessPiece->getPiece() == chessPiece::PIECE::PAWN;
     if (m_activatePromotion) performPromotion(p_chessPiece);
-    m_moveDB.push_back({source, destination});
+    recordMove(Move(source, destination, type), irreversible);
+    updateCheckers({p_chessPiece}, {from});
+}
+
+// After a move only the pieces which arrived on a square can give a direct check, and a discovered check
+// can only come from a slider behind a square which was left, on the line from the king through it.
+// Called once the side to move is switched, Color is the side which is now in check or not.
+template <chessPiece::COLOR Color>
+void Chess::updateCheckers(std::initializer_list<const chessPiece*> arrived, std::initializer_list<int> vacated) {
+    m_checkers.clear();
+    const int king = squareIndex(piecesOf<Color>()[0]->getPosition());
+    for (const chessPiece* p_piece : arrived) {
+        if (p_piece->attacks(king)) m_checkers.push_back(static_cast<std::uint8_t>(squareIndex(p_piece->getPosition())));
+    }
+    for (int square : vacated) {
+        int fileStep = (square % 8 > king % 8) - (square % 8 < king % 8);
+        int rankStep = (square / 8 > king / 8) - (square / 8 < king / 8);
+        bool straight = !fileStep || !rankStep;
+        if (square == king || (!straight && std::abs(square % 8 - king % 8) != std::abs(square / 8 - king / 8))) continue; // not on a line
+        int file = king % 8 + fileStep, rank = king / 8 + rankStep;
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8 && !m_chessBoard->isSquareOccupied(rank * 8 + file)) {
+            file += fileStep;
+            rank += rankStep;
+        }
+        const int found = rank * 8 + file;
+        if (file < 0 || file >= 8 || rank < 0 || rank >= 8 || m_checkers.contains(static_cast<std::uint8_t>(found))) continue;
+        for (const chessPiece* p_piece : piecesOf<opponentOf<Color>>()) {
+            chessPiece::PIECE type = p_piece->getPiece();
+            if ((type == chessPiece::PIECE::QUEEN || type == (straight ? chessPiece::PIECE::ROOK : chessPiece::PIECE::BISHOP)) &&
+                squareIndex(p_piece->getPosition()) == found) {
+                m_checkers.push_back(static_cast<std::uint8_t>(found));
+                break;
+            }
+        }
+    }
+}
+
+void Chess::updateCheckers(std::initializer_list<const chessPiece*> arrived, std::initializer_list<int> vacated) {
+    if (m_sideToMove == chessPiece::COLOR::WHITE) updateCheckers<chessPiece::COLOR::WHITE>(arrived, vacated);
+    else updateCheckers<chessPiece::COLOR::BLACK>(arrived, vacated);
+}
+
+// full count, for a position which was not reached by move()
+void Chess::findMaterialKey() {
+    m_materialKey = 0;
+    for (const auto* pieces : {&whitePieces, &blackPieces}) {
+        for (const chessPiece* p_piece : *pieces) {
+            m_materialKey += material::unit(p_piece->getColor(), p_piece->getPiece(), squareIndex(p_piece->getPosition()));
+        }
+    }
+}
+
+// full scan, for a position which was not reached by move()
+void Chess::findCheckers() {
+    m_checkers.clear();
+    auto attackers = (m_sideToMove == chessPiece::COLOR::WHITE) ? findKingAttackers<chessPiece::COLOR::WHITE>() : findKingAttackers<chessPiece::COLOR::BLACK>();
+    for (chessPiece* p_attacker : attackers) {
+        m_checkers.push_back(static_cast<std::uint8_t>(squareIndex(p_attacker->getPosition())));
+    }
+}
+
+// all legal moves of the side to move, checked by the same isValidMove the game uses
+void Chess::getLegalMoves(std::vector<Move>& moves) {
+    moves.clear();
+    const auto& pieces = (m_sideToMove == chessPiece::COLOR::WHITE) ? whitePieces : blackPieces;
+    for (chessPiece* p_piece : pieces) {
+        std::string source = p_piece->getPosition();
+        SquareList candidates;
+        p_piece->collectAttackingSquares(candidates);
+        if (p_piece->getPiece() == chessPiece::PIECE::PAWN) {
+            static_cast<Pawn*>(p_piece)->collectPushes(candidates);
+        }
+        // castling, isValidInput drops the squares off the board
+        if (p_piece->getPiece() == chessPiece::PIECE::KING && p_piece->isFirstMove()) {
+            int square = squareIndex(source);
+            if (square % 8 + 2 < 8) candidates.push_back(static_cast<std::uint8_t>(square + 2));
+            if (square % 8 - 2 >= 0) candidates.push_back(static_cast<std::uint8_t>(square - 2));
+        }
+        for (int candidate : candidates) {
+            std::string destination = squareName(candidate);
+            if (!isValidInput(source, destination)) continue;
+            bool valid = isValidMove(source, destination);
+            bool castling = m_activateCastling;
+            bool enPassant = m_enPassant;
+            resetFlags();
+            if (!valid) continue;
+            Move::TYPE type = Move::TYPE::NORMAL;
+            if (castling) type = Move::TYPE::CASTLING;
+            else if (enPassant) type = Move::TYPE::EN_PASSANT;
+            else if (p_piece->getPiece() == chessPiece::PIECE::PAWN && (destination[1] == '8' || destination[1] == '1')) type = Move::TYPE::PROMOTION;
+            moves.push_back(Move(source, destination, type));
+        }
+    }
+}
+
+// irreversible: a capture or a pawn move, resets the halfmove clock
+void Chess::recordMove(Move move, bool irreversible) {
+    m_moveDB.push_back(move);
+    m_halfmoveClock = irreversible ? 0 : m_halfmoveClock + 1;
+    if (m_sideToMove == chessPiece::COLOR::BLACK) ++m_fullmoveNumber;
+    m_sideToMove = (m_sideToMove == chessPiece::COLOR::WHITE) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+}
+
+// castling is still possible if the king and the rook are on their first move, attacks are not considered
+std::uint8_t Chess::getCastlingRights() const {
+    auto unmoved = [this](const std::string& position, chessPiece::PIECE piece, chessPiece::COLOR color) {
+        chessPiece* p_piece = getPieceFromPosition(position);
+        return p_piece && p_piece->getPiece() == piece && p_piece->getColor() == color && p_piece->isFirstMove();
+    };
+    std::uint8_t rights = 0;
+    if (unmoved("e1", chessPiece::PIECE::KING, chessPiece::COLOR::WHITE)) {
+        if (unmoved("h1", chessPiece::PIECE::ROOK, chessPiece::COLOR::WHITE)) rights |= zobrist::WHITE_KING_SIDE;
+        if (unmoved("a1", chessPiece::PIECE::ROOK, chessPiece::COLOR::WHITE)) rights |= zobrist::WHITE_QUEEN_SIDE;
+    }
+    if (unmoved("e8", chessPiece::PIECE::KING, chessPiece::COLOR::BLACK)) {
+        if (unmoved("h8", chessPiece::PIECE::ROOK, chessPiece::COLOR::BLACK)) rights |= zobrist::BLACK_KING_SIDE;
+        if (unmoved("a8", chessPiece::PIECE::ROOK, chessPiece::COLOR::BLACK)) rights |= zobrist::BLACK_QUEEN_SIDE;
+    }
+    return rights;
+}
+
+// file of the pawn which has just made a 2 squares move and can be taken en passant, -1 otherwise
+int Chess::getEnPassantFile() const {
+    Move lastMove = getLastMove();
+    if (lastMove.isNull() || std::abs(lastMove.from() - lastMove.to()) != 16) return -1;
+    std::string destination = lastMove.destination();
+    chessPiece* p_pawn = getPieceFromPosition(destination);
+    if (!p_pawn || p_pawn->getPiece() != chessPiece::PIECE::PAWN) return -1;
+    // only if there is a pawn which can capture it, otherwise the position is the same
+    for (int side : {-1, 1}) {
+        std::string neighbour = destination;
+        neighbour[0] += side;
+        chessPiece* p_neighbour = getPieceFromPosition(neighbour);
+        if (p_neighbour && p_neighbour->getPiece() == chessPiece::PIECE::PAWN && p_neighbour->getColor() != p_pawn->getColor()) {
+            return destination[0] - 'a';
+        }
+    }
+    return -1;
+}
+
+// zobrist hash of the current position: pieces, side to move, castling rights and en passant file
+std::uint64_t Chess::getHash() const {
+    std::uint64_t hash = 0;
+    for (const auto* pieces : {&whitePieces, &blackPieces}) {
+        for (chessPiece* p_piece : *pieces) {
+            hash ^= zobrist::KEYS.piece[static_cast<int>(p_piece->getColor())][static_cast<int>(p_piece->getPiece())]
+                                       [squareIndex(p_piece->getPosition())];
+        }
+    }
+    std::uint8_t rights = getCastlingRights();
+    for (int i = 0; i < 4; ++i) {
+        if (rights & (1 << i)) hash ^= zobrist::KEYS.castling[i];
+    }
+    int enPassantFile = getEnPassantFile();
+    if (enPassantFile >= 0) hash ^= zobrist::KEYS.enPassant[enPassantFile];
+    if (m_sideToMove == chessPiece::COLOR::BLACK) hash ^= zobrist::KEYS.blackToMove;
+    return hash;
+}
+
+Position Chess::getPosition() const {
+    Position position{};
+    for (const auto* pieces : {&whitePieces, &blackPieces}) {
+        for (chessPiece* p_piece : *pieces) {
+            position.place(p_piece->getColor(), p_piece->getPiece(), squareIndex(p_piece->getPosition()));
+        }
+    }
+    position.hash = getHash();
+    position.fullmoveNumber = static_cast<std::uint16_t>(m_fullmoveNumber);
+    position.halfmoveClock = static_cast<std::uint8_t>(std::min(m_halfmoveClock, 255));
+    position.sideToMove = static_cast<std::uint8_t>(m_sideToMove);
+    position.castlingRights = getCastlingRights();
+    position.enPassantFile = static_cast<std::int8_t>(getEnPassantFile());
+    return position;
+}
+
+// rebuilds the pieces from the snapshot, the move history is cleared.
+// En passant is decided from the last move, so if the snapshot has an en passant file
+// the history holds that double pawn push only.
+void Chess::setPosition(const Position& position) {
+    std::vector<PiecePlacement> placements;
+    for (int square = 0; square < 64; ++square) {
+        chessPiece::PIECE piece = position.pieceAt(square);
+        if (piece != chessPiece::PIECE::NONE) placements.push_back({piece, position.colorAt(square), square});
+    }
+    setupPosition(placements, position.side(), position.castlingRights);
+    if (position.enPassantFile >= 0) {
+        // the pawn which has moved belongs to the side which is not to move
+        bool whitePawn = position.side() == chessPiece::COLOR::BLACK;
+        int from = position.enPassantFile + (whitePawn ? 8 : 48);
+        m_moveDB.push_back(Move(from, from + (whitePawn ? 16 : -16)));
+    }
+    m_halfmoveClock = position.halfmoveClock;
+    m_fullmoveNumber = position.fullmoveNumber;
+    if (position.hash && getHash() != position.hash) throw std::logic_error("Position hash mismatch\n");
 }
 
 bool Chess::isWhiteMoved(const std::string& source) {
@@ -750,57 +1016,76 @@ bool Chess::isBlackMoved(const std::string& source) {
     return (getPieceFromPosition(source)->getColor() == chessPiece::COLOR::BLACK);
 }
 
-bool Chess::isWhiteStalemate() {
-    bool flag = true;
-    if (isWhiteKingUnderAttack()) return false;
-    for (chessPiece* p_piece : whitePieces) {
-        std::string sourcePos = p_piece->getPosition();
-        std::vector<std::string> attackingSquares = p_piece->getAttackingSquares();
-        if (p_piece->getPiece() == chessPiece::PIECE::PAWN) {
-            Pawn* p_pawn = dynamic_cast<Pawn*>(p_piece);
-            if (p_pawn) {
-                for (std::string s : p_pawn->getValidMovesWithoutAttack()) {
-                    attackingSquares.push_back(s);
-                }
-            }
-        }
-        for (std::string dest : attackingSquares) {
-            if (isValidMove(sourcePos, dest)) {
-                flag = false;
-            }
-            if (!flag) return false;
-        }
+bool Chess::isValidInput(const std::string& source, const std::string& destination) const {
+    if (source.size() != 2 || destination.size() != 2 || source == destination) {
+        return false;
+    }
+    if (source[0] < 'a' || source[0] > 'h' || 
+        destination[0] < 'a' || destination[0] > 'h' ||
+        source[1] < '1' || source[1] > '8' ||
+        destination[1] < '1' || destination[1] > '8'){
+        return false;
+    }
+    if (!getPieceFromPosition(source)) return false;
+    return true;
+}
+
+// the single validation path for one ply: input syntax, side to move, game rules.
+// performs the move if everything is fine, the flags are reset in both cases.
+bool Chess::makeMove(chessPiece::COLOR side, const std::string& source, const std::string& destination) {
+    resetFlags(); // the status checks validate moves too and may leave them set
+    if (!isValidInput(source, destination) || getPieceFromPosition(source)->getColor() != side || !isValidMove(source, destination)) {
+        resetFlags();
+        return false;
+    }
+    move(source, destination);
+    resetFlags();
+    return true;
+}
+
+bool Chess::makeMove(chessPiece::COLOR side, Move move) {
+    return makeMove(side, move.source(), move.destination());
+}
+
+// game status for the side which is going to move next, checks are done in the same order as the Game does
+Chess::STATUS Chess::getStatus(chessPiece::COLOR sideToMove) {
+    CHESS_ALLOC_SCOPE(STATUS);
+    if (sideToMove == chessPiece::COLOR::WHITE) {
+        if (isWhiteCheckMated()) return STATUS::CHECKMATE;
+        if (isWhiteStalemate()) return STATUS::STALEMATE;
+    } else {
+        if (isBlackCheckMated()) return STATUS::CHECKMATE;
+        if (isBlackStalemate()) return STATUS::STALEMATE;
     }
-    return flag;
+    if (material::isInsufficient(m_materialKey)) return STATUS::INSUFFICIENT_MATERIAL;
+    if (m_halfmoveClock >= FIFTY_MOVES_PLIES) return STATUS::FIFTY_MOVES;
+    if (isRepetition()) return STATUS::REPETITION;
+    return STATUS::NONE;
 }
 
-bool Chess::isBlackStalemate() {
-    bool flag = true;
-    if (isBlackKingUnderAttack()) return false;
-    for (chessPiece* p_piece : blackPieces) {
+template <chessPiece::COLOR Color>
+bool Chess::isStalemate() {
+    if (isKingUnderAttack<Color>()) return false;
+    SquareList squares;
+    for (chessPiece* p_piece : piecesOf<Color>()) {
         std::string sourcePos = p_piece->getPosition();
-        std::vector<std::string> attackingSquares = p_piece->getAttackingSquares();
+        squares.clear();
+        p_piece->collectAttackingSquares(squares);
         if (p_piece->getPiece() == chessPiece::PIECE::PAWN) {
-            Pawn* p_pawn = dynamic_cast<Pawn*>(p_piece);
-            if (p_pawn) {
-                for (std::string s : p_pawn->getValidMovesWithoutAttack()) {
-                    attackingSquares.push_back(s);
-                }
-            }
+            static_cast<Pawn*>(p_piece)->collectPushes(squares);
         }
-        for (std::string dest : attackingSquares) {
-            if (isValidMove(sourcePos, dest)) {
-                flag = false;
+        for (int square : squares) {
+            if (isValidMove(sourcePos, squareName(square))) {
+                return false;
             }
-            if (!flag) return false;
         }
     }
-    return flag;
+    return true;
 }
 
 
 bool Chess::isRepetition() const {
-    std::vector<std::pair<std::string, std::string>> lastThreeMoves;
+    std::vector<Move> lastThreeMoves;
     int count = 12;
     for (int i = m_moveDB.size() - 1; i >= 0 && count; --i) {
         lastThreeMoves.push_back(m_moveDB[i]);
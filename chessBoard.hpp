@@ -15,6 +15,7 @@
 #ifndef CHESSBOARD_H_
 #define CHESSBOARD_H_
 
+#include "instrumentation.hpp"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -33,15 +34,24 @@ public:
     chessBoard& operator=(chessBoard&&) = default;
 
     void show() const;
+    const std::vector<std::vector<wchar_t>>& getMatrix() const {
+        return m_board;
+    }
     std::unordered_map<std::string, wchar_t*>& getBoardMap() {
         return m_map;
     }
     bool isSquareOccupied(const std::string& position) {
+        CHESS_INSTRUMENT(IS_SQUARE_OCCUPIED);
         if (m_map.find(position) != m_map.end()) {
             return (*m_map[position]) != '_';
         }
         return false;
     }
+    // square is a squareIndex value (a1 = 0), no lookup in the map
+    bool isSquareOccupied(int square) const {
+        CHESS_INSTRUMENT(IS_SQUARE_OCCUPIED);
+        return m_board[8 - square / 8][2 + 2 * (square % 8)] != '_';
+    }
 
 private:
     std::vector<std::vector<wchar_t>> m_board;
@@ -134,14 +144,16 @@ chessBoard::chessBoard() {
     m_map["h8"] = &m_board[1][16];
 }
 
+// the whole board in one buffer and one flush, the locale is set on the first call only
 void chessBoard::show() const {
-    setlocale(LC_CTYPE,"");
+    static const bool localeSet = setlocale(LC_CTYPE, "") != nullptr;
+    (void)localeSet;
+    std::wstring frame;
     for (const auto& v : m_board) {
-        for (const wchar_t c : v) {
-            std::wcout << c;
-        }
-        std::wcout << std::endl;
+        frame.append(v.begin(), v.end());
+        frame.push_back(L'\n');
     }
+    std::wcout << frame << std::flush;
 }
 
 } // CHESS
@@ -12,6 +12,8 @@
  *  if the piece is (queen, rook or bishop) they don't see the squares behind the piece they attack.
  *  Attacking path is writted for mentioned 3 pieces which has "path" idea.
  *  Giving the destination they will return the path to the particular square, skipping occupied squares.
+ *  Both are computed by collectAttackingSquares and collectAttackingPath into a SquareList (squareList.hpp),
+ *  which the hot paths use without any allocation, the vector returning functions are kept as adapters.
  * 
  *  isValidMove is checking only if the move is valid due to the game rules, which is only a part of isValidMove of chess class.
  *  
@@ -27,9 +29,11 @@
 
 
 #include "chessBoard.hpp"
+#include "squareList.hpp"
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
 
 namespace CHESS {
 
@@ -43,19 +47,123 @@ public:
     virtual void setPosition(const std::string&) = 0;
     virtual std::string getPosition() const = 0;
     virtual PIECE getPiece() const = 0;
-    virtual std::vector<std::string> getAttackingSquares() = 0;
     virtual bool isFirstMove() const;
-    virtual std::vector<std::string> getAttackingPath(const std::string&);
+    virtual void setFirstMove(bool);
+
+    // allocation-free forms, the squares are squareIndex values
+    virtual void collectAttackingSquares(SquareList&) const = 0;
+    virtual void collectAttackingPath(int destination, SquareList&) const;
+    std::uint64_t getAttackMask() const;
+    bool attacks(int square) const;
+
+    // adapters over the collect functions for the callers working with square names
+    std::vector<std::string> getAttackingSquares() const;
+    std::vector<std::string> getAttackingPath(const std::string&) const;
 
     virtual ~chessPiece() = default;
+
+protected:
+    static void collectSteps(const int (*steps)[2], int count, int square, SquareList&);
+    static void collectSlides(const chessBoard&, const int (*directions)[2], int count, int square, SquareList&);
+    static void collectLine(int square, int destination, bool straight, bool diagonal, SquareList&);
+
+    static constexpr int STRAIGHT[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static constexpr int DIAGONAL[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    static constexpr int QUEEN_DIRECTIONS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    static constexpr int KING_STEPS[8][2] = {{1, 0}, {1, -1}, {1, 1}, {0, 1}, {0, -1}, {-1, 0}, {-1, 1}, {-1, -1}};
+    static constexpr int KNIGHT_STEPS[8][2] = {{2, 1}, {2, -1}, {1, 2}, {1, -2}, {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}};
 };
 
 bool chessPiece::isFirstMove() const {
     return false;
 }
 
-std::vector<std::string> chessPiece::getAttackingPath(const std::string&) {
-    return {};
+// only for the pieces which care about the first move (king, rook, pawn), used for position setup
+void chessPiece::setFirstMove(bool) {
+}
+
+// only queen, rook and bishop have paths
+void chessPiece::collectAttackingPath(int, SquareList&) const {
+}
+
+std::uint64_t chessPiece::getAttackMask() const {
+    SquareList squares;
+    collectAttackingSquares(squares);
+    std::uint64_t mask = 0;
+    for (int square : squares) {
+        mask |= squareBit(square);
+    }
+    return mask;
+}
+
+bool chessPiece::attacks(int square) const {
+    SquareList squares;
+    collectAttackingSquares(squares);
+    return squares.contains(square);
+}
+
+std::vector<std::string> chessPiece::getAttackingSquares() const {
+    SquareList squares;
+    collectAttackingSquares(squares);
+    std::vector<std::string> res;
+    for (int square : squares) {
+        res.push_back(squareName(square));
+    }
+    return res;
+}
+
+std::vector<std::string> chessPiece::getAttackingPath(const std::string& destination) const {
+    SquareList squares;
+    collectAttackingPath(squareIndex(destination), squares);
+    std::vector<std::string> res;
+    for (int square : squares) {
+        res.push_back(squareName(square));
+    }
+    return res;
+}
+
+// king, knight and pawn: single steps which stay on the board
+void chessPiece::collectSteps(const int (*steps)[2], int count, int square, SquareList& out) {
+    CHESS_INSTRUMENT(GET_ATTACKING_SQUARES);
+    const int file = square % 8, rank = square / 8;
+    for (int i = 0; i < count; ++i) {
+        int f = file + steps[i][0], r = rank + steps[i][1];
+        if (f >= 0 && f < 8 && r >= 0 && r < 8) {
+            out.push_back(static_cast<std::uint8_t>(r * 8 + f));
+        }
+    }
+}
+
+// sliders: every direction up to the first occupied square, the square with the attacked piece is also included
+void chessPiece::collectSlides(const chessBoard& board, const int (*directions)[2], int count, int square, SquareList& out) {
+    CHESS_INSTRUMENT(GET_ATTACKING_SQUARES);
+    for (int i = 0; i < count; ++i) {
+        int f = square % 8 + directions[i][0], r = square / 8 + directions[i][1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8) {
+            out.push_back(static_cast<std::uint8_t>(r * 8 + f));
+            if (board.isSquareOccupied(r * 8 + f)) {
+                break;
+            }
+            f += directions[i][0];
+            r += directions[i][1];
+        }
+    }
+}
+
+// the squares from the piece to the destination, both included, regardless of the occupation.
+// Nothing if the destination is not on a line the piece moves along.
+void chessPiece::collectLine(int square, int destination, bool straight, bool diagonal, SquareList& out) {
+    CHESS_INSTRUMENT(GET_ATTACKING_PATH);
+    int df = destination % 8 - square % 8, dr = destination / 8 - square / 8;
+    if (!df && !dr) return;
+    bool onStraight = !df || !dr;
+    bool onDiagonal = std::abs(df) == std::abs(dr);
+    if (!(straight && onStraight) && !(diagonal && onDiagonal)) return;
+    int sf = (df > 0) - (df < 0), sr = (dr > 0) - (dr < 0);
+    for (int current = square; ; current += sr * 8 + sf) {
+        out.push_back(static_cast<std::uint8_t>(current));
+        if (current == destination) break;
+    }
 }
 
 class King : public chessPiece {
@@ -76,12 +184,7 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        for (std::string pos : getAttackingSquares()) {
-            if (pos == destination) {
-                return true;
-            }
-        }
-        return false;
+        return attacks(squareIndex(destination));
     }
 
     void move(const std::string& destination) override {
@@ -98,6 +201,10 @@ public:
         return m_firstMove;
     }
 
+    void setFirstMove(bool firstMove) override {
+        m_firstMove = firstMove;
+    }
+
     COLOR getColor() const override {
         return m_color;
     }
@@ -120,26 +227,8 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        std::string tmp1 = pos; ++tmp1[0]; vec.push_back(tmp1);
-        std::string tmp2 = pos; ++tmp2[0]; --tmp2[1]; vec.push_back(tmp2);
-        std::string tmp3 = pos; ++tmp3[0]; ++tmp3[1]; vec.push_back(tmp3);
-        std::string tmp4 = pos; ++tmp4[1]; vec.push_back(tmp4);
-        std::string tmp5 = pos; --tmp5[1]; vec.push_back(tmp5);
-        std::string tmp6 = pos; --tmp6[0]; vec.push_back(tmp6);
-        std::string tmp7 = pos; --tmp7[0]; ++tmp7[1]; vec.push_back(tmp7);
-        std::string tmp8 = pos; --tmp8[0]; --tmp8[1]; vec.push_back(tmp8);
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        collectSteps(KING_STEPS, 8, squareIndex(m_position), out);
     }
 
 private:
@@ -168,12 +257,7 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        for (std::string pos : getAttackingSquares()) {
-            if (pos == destination) {
-                return true;
-            }
-        }
-        return false;
+        return attacks(squareIndex(destination));
     }
     void move(const std::string& destination) override {
         auto& tmpBoardMap = m_chessBoard->getBoardMap();
@@ -204,159 +288,12 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        char letter = pos[0];
-        char digit = pos[1];
-        ++letter;
-        while (letter <= 'h') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) { // the square with the attacked piece is also included
-                break;
-            }
-            ++letter;
-        }
-        letter = pos[0]; --letter;
-        while (letter >= 'a') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter;
-        }
-        letter = pos[0]; ++digit;
-        while (digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++digit;
-        }
-        digit = pos[1]; --digit;
-        while (digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --digit;
-        }
-        digit = pos[1];
-        ++letter; ++digit;
-        while (letter <= 'h' && digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++letter; ++digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        ++letter; --digit;
-        while (letter <= 'h' && digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++letter; --digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        --letter; ++digit;
-        while (letter >= 'a' && digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter; ++digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        --letter; --digit;
-        while (letter >= 'a' && digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter; --digit;
-        }
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        collectSlides(*m_chessBoard, QUEEN_DIRECTIONS, 8, squareIndex(m_position), out);
     }
 
-    std::vector<std::string> getAttackingPath(const std::string& destination) {
-        std::vector<std::string> attackingPathVec;
-        std::string pos = m_position;
-        if (pos[0] == destination[0] && pos[1] < destination[1]) {
-            while (pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[1];
-            }
-            return attackingPathVec;
-        } 
-        pos = m_position;
-        if (pos[0] == destination[0] && pos[1] > destination[1]) {
-            while (pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[1];
-            }
-            return attackingPathVec;
-        }
-        pos = m_position;
-        if (pos[0] < destination[0] && pos[1] == destination[1]) {
-            while (pos[0] <= destination[0]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0];
-            }
-            return attackingPathVec;
-        }
-        pos = m_position;
-        if (pos[0] > destination[0] && pos[1] == destination[1]) {
-            while (pos[0] >= destination[0]) {
-                attackingPathVec.push_back(pos);
-                --pos[0];
-            }
-            return attackingPathVec;
-        }
-        
-        pos = m_position;
-        if (pos[0] < destination[0] && pos[1] < destination[1]) {  // left down
-            while (pos[0] <= destination[0] && pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0]; ++pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] > destination[0] && pos[1] < destination[1]) { // right down
-            while (pos[0] >= destination[0] && pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[0]; ++pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] < destination[0] && pos[1] > destination[1]) { // left up
-            while (pos[0] <= destination[0] && pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0]; --pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] > destination[0] && pos[1] > destination[1]) { // right up
-            while (pos[0] >= destination[0] && pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[0]; --pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        return {};
+    void collectAttackingPath(int destination, SquareList& out) const override {
+        collectLine(squareIndex(m_position), destination, true, true, out);
     }
 
 private:
@@ -384,12 +321,7 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        for (std::string pos : getAttackingSquares()) {
-            if (pos == destination) {
-                return true;
-            }
-        }
-        return false;
+        return attacks(squareIndex(destination));
     }
     void move(const std::string& destination) override {
         auto& tmpBoardMap = m_chessBoard->getBoardMap();
@@ -420,94 +352,12 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        char letter = pos[0];
-        char digit = pos[1];
-        ++letter; ++digit;
-        while (letter <= 'h' && digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++letter; ++digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        ++letter; --digit;
-        while (letter <= 'h' && digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++letter; --digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        --letter; ++digit;
-        while (letter >= 'a' && digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter; ++digit;
-        }
-        letter = pos[0]; digit = pos[1];
-        --letter; --digit;
-        while (letter >= 'a' && digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter; --digit;
-        }
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        collectSlides(*m_chessBoard, DIAGONAL, 4, squareIndex(m_position), out);
     }
 
-    std::vector<std::string> getAttackingPath(const std::string& destination) {
-        std::vector<std::string> attackingPathVec;        
-        std::string pos = m_position;
-        if (pos[0] < destination[0] && pos[1] < destination[1]) {  // left down
-            while (pos[0] <= destination[0] && pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0]; ++pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] > destination[0] && pos[1] < destination[1]) { // right down
-            while (pos[0] >= destination[0] && pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[0]; ++pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] < destination[0] && pos[1] > destination[1]) { // left up
-            while (pos[0] <= destination[0] && pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0]; --pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        if (pos[0] > destination[0] && pos[1] > destination[1]) { // right up
-            while (pos[0] >= destination[0] && pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[0]; --pos[1];
-            }
-            return attackingPathVec;
-        }
-
-        return {};
+    void collectAttackingPath(int destination, SquareList& out) const override {
+        collectLine(squareIndex(m_position), destination, false, true, out);
     }
 
 private:
@@ -535,12 +385,7 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        for (std::string pos : getAttackingSquares()) {
-            if (pos == destination) {
-                return true;
-            }
-        }
-        return false;
+        return attacks(squareIndex(destination));
     }
 
     void move(const std::string& destination) override {
@@ -557,6 +402,10 @@ public:
         return m_firstMove;
     }
 
+    void setFirstMove(bool firstMove) override {
+        m_firstMove = firstMove;
+    }
+
     COLOR getColor() const override {
         return m_color;
     }
@@ -579,91 +428,12 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        char letter = pos[0];
-        char digit = pos[1];
-        ++letter;
-        while (letter <= 'h') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++letter;
-        }
-        letter = pos[0]; --letter;
-        while (letter >= 'a') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --letter;
-        }
-        letter = pos[0]; ++digit;
-        while (digit <= '8') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            ++digit;
-        }
-        digit = pos[1]; --digit;
-        while (digit >= '1') {
-            vec.push_back({letter, digit});
-            if (m_chessBoard->isSquareOccupied({letter, digit})) {
-                break;
-            }
-            --digit;
-        }
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        collectSlides(*m_chessBoard, STRAIGHT, 4, squareIndex(m_position), out);
     }
 
-    std::vector<std::string> getAttackingPath(const std::string& destination) {
-        std::vector<std::string> attackingPathVec;
-        std::string pos = m_position;
-        if (pos[0] == destination[0] && pos[1] < destination[1]) {
-            while (pos[1] <= destination[1]) {
-                attackingPathVec.push_back(pos);
-                ++pos[1];
-            }
-            return attackingPathVec;
-        } 
-        pos = m_position;
-        if (pos[0] == destination[0] && pos[1] > destination[1]) {
-            while (pos[1] >= destination[1]) {
-                attackingPathVec.push_back(pos);
-                --pos[1];
-            }
-            return attackingPathVec;
-        }
-        pos = m_position;
-        if (pos[0] < destination[0] && pos[1] == destination[1]) {
-            while (pos[0] <= destination[0]) {
-                attackingPathVec.push_back(pos);
-                ++pos[0];
-            }
-            return attackingPathVec;
-        }
-        pos = m_position;
-        if (pos[0] > destination[0] && pos[1] == destination[1]) {
-            while (pos[0] >= destination[0]) {
-                attackingPathVec.push_back(pos);
-                --pos[0];
-            }
-            return attackingPathVec;
-        }
-
-        return {};
+    void collectAttackingPath(int destination, SquareList& out) const override {
+        collectLine(squareIndex(m_position), destination, true, false, out);
     }
 
 private:
@@ -692,12 +462,7 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        for (std::string pos : getAttackingSquares()) {
-            if (pos == destination) {
-                return true;
-            }
-        }
-        return false;
+        return attacks(squareIndex(destination));
     }
     
     void move(const std::string& destination) override {
@@ -729,26 +494,8 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        std::string tmp1 = pos; tmp1[0] += 2; ++tmp1[1]; vec.push_back(tmp1);
-        std::string tmp2 = pos; tmp2[0] += 2; --tmp2[1]; vec.push_back(tmp2);
-        std::string tmp3 = pos; ++tmp3[0]; tmp3[1] += 2; vec.push_back(tmp3);
-        std::string tmp4 = pos; ++tmp4[0]; tmp4[1] -= 2; vec.push_back(tmp4);
-        std::string tmp5 = pos; tmp5[0] -= 2; ++tmp5[1]; vec.push_back(tmp5);
-        std::string tmp6 = pos; tmp6[0] -= 2; --tmp6[1]; vec.push_back(tmp6);
-        std::string tmp7 = pos; --tmp7[0]; tmp7[1] += 2; vec.push_back(tmp7);
-        std::string tmp8 = pos; --tmp8[0]; tmp8[1] -= 2; vec.push_back(tmp8);
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        collectSteps(KNIGHT_STEPS, 8, squareIndex(m_position), out);
     }
 
 private:
@@ -776,19 +523,18 @@ public:
         if (boardMap.find(source) == boardMap.end() || boardMap.find(destination) == boardMap.end() || source == destination) {
             return false;
         }
-        if (m_chessBoard->isSquareOccupied(destination)) {
-            auto vec = getAttackingSquares();
-            if (std::find(vec.begin(), vec.end(), destination) == vec.end()) {
-                return false;
-            }
+        if (m_chessBoard->isSquareOccupied(destination) && !attacks(squareIndex(destination))) {
+            return false;
         }
 
         if (m_color == chessPiece::COLOR::WHITE && destination[1] <= source[1] || 
             m_color == chessPiece::COLOR::BLACK && destination[1] >= source[1]) {
                 return false;
         }
+        // the double step can't jump over a piece
+        int middle = (squareIndex(source) + squareIndex(destination)) / 2;
         return ( 
-                 (source[0] == destination[0] && (std::abs(destination[1] - source[1]) == 2) && m_firstMove) || 
+                 (source[0] == destination[0] && (std::abs(destination[1] - source[1]) == 2) && m_firstMove && !m_chessBoard->isSquareOccupied(middle)) || 
                  (source[0] == destination[0] && (std::abs(destination[1] - source[1]) == 1))
                );
     }
@@ -806,6 +552,10 @@ public:
         return m_firstMove;
     }
 
+    void setFirstMove(bool firstMove) override {
+        m_firstMove = firstMove;
+    }
+
     COLOR getColor() const override {
         return m_color;
     }
@@ -828,43 +578,30 @@ public:
         return m_piece;
     }
 
-    std::vector<std::string> getAttackingSquares() override {
-        std::vector<std::string> vec;
-        std::vector<std::string> res;
-        std::string pos = m_position;
-        if (m_color == COLOR::WHITE) {
-            std::string tmp1 = pos; ++tmp1[0]; ++tmp1[1]; vec.push_back(tmp1);
-            std::string tmp2 = pos; --tmp2[0]; ++tmp2[1]; vec.push_back(tmp2);
-        } else {
-            std::string tmp1 = pos; ++tmp1[0]; --tmp1[1]; vec.push_back(tmp1);
-            std::string tmp2 = pos; --tmp2[0]; --tmp2[1]; vec.push_back(tmp2);
-        }
-
-        auto& boardMap = m_chessBoard->getBoardMap();
-        for (auto it = vec.begin(); it != vec.end(); ++it) {
-            if (boardMap.find(*it) != boardMap.end()) {
-                res.push_back(*it);
-            }
-        }
-        return res;
+    void collectAttackingSquares(SquareList& out) const override {
+        static constexpr int WHITE_CAPTURES[2][2] = {{1, 1}, {-1, 1}};
+        static constexpr int BLACK_CAPTURES[2][2] = {{1, -1}, {-1, -1}};
+        collectSteps(m_color == COLOR::WHITE ? WHITE_CAPTURES : BLACK_CAPTURES, 2, squareIndex(m_position), out);
     }
 
     // for elimination check, as getting attacking squares in not enough
     // see the explanation in chess.hpp
-    std::vector<std::string> getValidMovesWithoutAttack() {
+    void collectPushes(SquareList& out) const {
+        int square = squareIndex(m_position);
+        int forward = (m_color == chessPiece::COLOR::WHITE) ? 8 : -8;
+        if (square + forward < 0 || square + forward > 63) return;
+        out.push_back(static_cast<std::uint8_t>(square + forward));
+        if (m_firstMove && square + 2 * forward >= 0 && square + 2 * forward <= 63) {
+            out.push_back(static_cast<std::uint8_t>(square + 2 * forward));
+        }
+    }
+
+    std::vector<std::string> getValidMovesWithoutAttack() const {
+        SquareList squares;
+        collectPushes(squares);
         std::vector<std::string> validMoves;
-        if (m_color == chessPiece::COLOR::WHITE) {
-            std::string pos = m_position;
-            std::string tmp1 = pos; ++tmp1[1]; validMoves.push_back(tmp1);
-            if (m_firstMove) {
-                std::string tmp2 = pos; tmp2[1] += 2; validMoves.push_back(tmp2);
-            }
-        } else {
-            std::string pos = m_position;
-            std::string tmp1 = pos; --tmp1[1]; validMoves.push_back(tmp1);
-            if (m_firstMove) {
-                std::string tmp2 = pos; tmp2[1] -= 2; validMoves.push_back(tmp2);
-            }
+        for (int square : squares) {
+            validMoves.push_back(squareName(square));
         }
         return validMoves;
     }
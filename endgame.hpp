@@ -0,0 +1,194 @@
+/**
+ * @file endgame.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Endgame handlers dispatched by the material key (material.hpp).
+ *
+ *  Endgames maps a material key to a handler which scores the position instead of the general evaluation:
+ *  dead draws, the mates against a bare king (the defending king is driven to the edge, or to a corner of
+ *  the bishop's color for KBNK) and KPK through a bitbase if one with the KPK table is given.
+ *  The map is an open addressing table at most 1/8 full, so the lookup of a node is a single probe
+ *  of one slot for almost every key, and nothing at all is walked to find the material:
+ *  a Chess keeps the key, a Position computes it with a popcount per piece kind.
+ *
+ *  Handlers are registered by signature with the extra material on the white side ("KBNK"), the same
+ *  material with the colors swapped is registered with the black side as the strong one.
+ *  Scores are from white's point of view in centipawns, as evaluation::evaluate.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ENDGAME_H_
+#define ENDGAME_H_
+
+#include "bitbase.hpp"
+#include "evaluation.hpp"
+#include "material.hpp"
+#include "position.hpp"
+#include <array>
+#include <cstdlib>
+#include <string_view>
+
+namespace CHESS {
+
+namespace endgame {
+
+// above any material balance, below the mate scores of the search
+constexpr int KNOWN_WIN = 10000;
+
+// the score of the position, strong is the side the handler was registered for
+using Evaluate = int (*)(const Position&, chessPiece::COLOR strong, const Bitbase* p_bitbase);
+
+struct Handler {
+    Evaluate evaluate = nullptr;
+    chessPiece::COLOR strong = chessPiece::COLOR::WHITE;
+};
+
+inline int distance(int a, int b) {
+    return std::max(std::abs(a % 8 - b % 8), std::abs(a / 8 - b / 8));
+}
+
+// 0 in the centre, 6 in a corner
+inline int edge(int square) {
+    return 6 - std::min(square % 8, 7 - square % 8) - std::min(square / 8, 7 - square / 8);
+}
+
+inline int kingSquare(const Position& position, chessPiece::COLOR color) {
+    return std::countr_zero(position.bitboard(color, chessPiece::PIECE::KING));
+}
+
+inline int fromWhite(chessPiece::COLOR strong, int score) {
+    return strong == chessPiece::COLOR::WHITE ? score : -score;
+}
+
+inline int draw(const Position&, chessPiece::COLOR, const Bitbase*) {
+    return 0;
+}
+
+// KQK, KRK, ...: the defending king to the edge, the attacking king next to it
+inline int mateBareKing(const Position& position, chessPiece::COLOR strong, const Bitbase*) {
+    const int weakKing = kingSquare(position, strong == chessPiece::COLOR::WHITE ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE);
+    const int material = std::abs(evaluation::evaluate(position).material);
+    return fromWhite(strong, KNOWN_WIN + material + 20 * edge(weakKing) + 10 * (7 - distance(kingSquare(position, strong), weakKing)));
+}
+
+// KBNK: the mate is only forced in a corner of the bishop's color
+inline int mateBishopKnight(const Position& position, chessPiece::COLOR strong, const Bitbase*) {
+    const int weakKing = kingSquare(position, strong == chessPiece::COLOR::WHITE ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE);
+    const bool light = position.bitboard(strong, chessPiece::PIECE::BISHOP) & material::LIGHT_SQUARES;
+    const int corner = light ? std::min(distance(weakKing, 7), distance(weakKing, 56)) : std::min(distance(weakKing, 0), distance(weakKing, 63));
+    const int material = std::abs(evaluation::evaluate(position).material);
+    return fromWhite(strong, KNOWN_WIN + material + 40 * (7 - corner) + 10 * (7 - distance(kingSquare(position, strong), weakKing)));
+}
+
+// KPK: exact with a bitbase, a won pawn scores more the further it is
+inline int kingPawnKing(const Position& position, chessPiece::COLOR strong, const Bitbase* p_bitbase) {
+    const bitbase::VALUE value = p_bitbase ? p_bitbase->probe(position) : bitbase::UNKNOWN;
+    if (value == bitbase::UNKNOWN) return evaluation::evaluate(position).total();
+    if (value == bitbase::DRAW) return 0;
+    const bool strongWins = (value == bitbase::WIN) == (position.side() == strong);
+    const int pawn = std::countr_zero(position.bitboard(strong, chessPiece::PIECE::PAWN));
+    const int rank = strong == chessPiece::COLOR::WHITE ? pawn / 8 : 7 - pawn / 8;
+    return strongWins ? fromWhite(strong, KNOWN_WIN + evaluation::MATERIAL[static_cast<int>(chessPiece::PIECE::PAWN)] + 10 * rank) : 0;
+}
+
+class Endgames {
+public:
+    explicit Endgames(const Bitbase* p_bitbase = nullptr); // the built-in handlers, KPK if the bitbase has it
+    Endgames(const Endgames&) = delete;
+    Endgames& operator=(const Endgames&) = delete;
+    Endgames(Endgames&&) = delete;
+    Endgames& operator=(Endgames&&) = delete;
+    ~Endgames() = default;
+
+    // every key of the signature and of its mirror, a key which is already there is replaced
+    void add(std::string_view signature, Evaluate evaluate);
+    void add(std::uint64_t materialKey, Handler handler);
+
+    // nullptr if the material has no handler
+    const Handler* probe(std::uint64_t materialKey) const {
+        for (std::size_t i = index(materialKey);; i = (i + 1) & (SLOTS - 1)) {
+            const Slot& slot = m_slots[i];
+            if (!slot.handler.evaluate) return nullptr;
+            if (slot.key == materialKey) return &slot.handler;
+        }
+    }
+    int evaluate(const Position& position, const Handler& handler) const {
+        return handler.evaluate(position, handler.strong, m_bitbase);
+    }
+    std::size_t size() const {
+        return m_size;
+    }
+
+private:
+    static constexpr std::size_t SLOTS = 512;
+
+    struct Slot {
+        std::uint64_t key = 0;
+        Handler handler; // no evaluate: an empty slot
+    };
+    static std::size_t index(std::uint64_t key) {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 55); // 9 bits, SLOTS
+    }
+
+    std::array<Slot, SLOTS> m_slots{};
+    std::size_t m_size = 0;
+    const Bitbase* m_bitbase;
+};
+
+Endgames::Endgames(const Bitbase* p_bitbase) : m_bitbase(p_bitbase) {
+    // the dead draws, KNNK can't be forced either
+    for (std::string_view signature : {"KK", "KBK", "KNK", "KBKB", "KNNK"}) {
+        for (std::uint64_t key : material::keysOf(signature)) {
+            if (!material::isInsufficient(key) && signature != "KNNK") continue;
+            add(key, {draw, chessPiece::COLOR::WHITE});
+            add(material::mirrored(key), {draw, chessPiece::COLOR::BLACK});
+        }
+    }
+    for (std::string_view signature : {"KQK", "KRK", "KQQK", "KQRK", "KRRK", "KQBK", "KQNK", "KRBK", "KRNK"}) {
+        add(signature, mateBareKing);
+    }
+    // the bishops of KBBK on one color can't mate
+    for (std::uint64_t key : material::keysOf("KBBK")) {
+        if (material::isInsufficient(key)) continue;
+        add(key, {mateBareKing, chessPiece::COLOR::WHITE});
+        add(material::mirrored(key), {mateBareKing, chessPiece::COLOR::BLACK});
+    }
+    add("KBNK", mateBishopKnight);
+    if (p_bitbase && p_bitbase->contains("KPK")) add("KPK", kingPawnKing);
+}
+
+void Endgames::add(std::string_view signature, Evaluate evaluate) {
+    const auto keys = material::keysOf(signature);
+    if (keys.empty()) throw std::logic_error("Bad material signature " + std::string(signature));
+    for (std::uint64_t key : keys) {
+        add(key, {evaluate, chessPiece::COLOR::WHITE});
+        add(material::mirrored(key), {evaluate, chessPiece::COLOR::BLACK});
+    }
+}
+
+void Endgames::add(std::uint64_t materialKey, Handler handler) {
+    std::size_t i = index(materialKey);
+    while (m_slots[i].handler.evaluate && m_slots[i].key != materialKey) i = (i + 1) & (SLOTS - 1);
+    if (!m_slots[i].handler.evaluate) {
+        if ((m_size + 1) * 8 > SLOTS) throw std::logic_error("Too many endgame handlers\n");
+        ++m_size;
+    }
+    m_slots[i] = {materialKey, handler};
+}
+
+// the built-in handlers without a bitbase, shared by the searches
+inline const Endgames& defaultEndgames() {
+    static const Endgames endgames;
+    return endgames;
+}
+
+} // endgame
+
+} // CHESS
+
+#endif
@@ -12,7 +12,14 @@
  */
 
 #include "chess.hpp"
+#include "gameArchive.hpp"
+#include "polyglotBook.hpp"
+#include "gameSession.hpp"
+#include "boardRenderer.hpp"
+#include "search.hpp"
+#include <memory>
 #include <sstream>
+#include <iomanip>
 #include <execinfo.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -38,138 +45,234 @@ namespace CHESS {
 class Game {
 public:
     Game();
+    explicit Game(const std::string& archivePath);
     ~Game();
     void play();
+    void playHeadless(std::istream& moves, std::ostream& out);
     void welcome() const;
     void display() const;
     std::pair<std::string, std::string> getMoves(const std::string&) const; 
     bool isValidInput(const std::string& source, const std::string& destination);
+    void setBook(const std::string& bookPath);
+    void showBookMoves() const;
+    void showAnalysis(int depth, int lines) const;
 public:
     Chess* m_chess = nullptr;
+    std::string m_archivePath; // finished games are appended here if set
+    std::unique_ptr<PolyglotBook> m_book;
+    mutable BoardRenderer m_renderer;
 };
 
 Game::Game() {
     m_chess = new Chess();
 }
 
+Game::Game(const std::string& archivePath) : Game() {
+    m_archivePath = archivePath;
+}
+
 Game::~Game() {
     delete m_chess;
 }
 
+// throws if the book can't be loaded, the previous book is kept then
+void Game::setBook(const std::string& bookPath) {
+    auto book = std::make_unique<PolyglotBook>(bookPath);
+    m_book.swap(book);
+}
+
+// "book" input: the book moves of the current position with their weights
+void Game::showBookMoves() const {
+    if (!m_book) {
+        std::wcout << "no opening book" << std::endl;
+        return;
+    }
+    auto moves = m_book->probe(*m_chess);
+    if (moves.empty()) std::wcout << "out of book" << std::endl;
+    for (const BookMove& bookMove : moves) {
+        std::string move = bookMove.move.source() + bookMove.move.destination();
+        std::wcout << std::wstring(move.begin(), move.end()) << " " << bookMove.weight << std::endl;
+    }
+}
+
+// "analyse [depth] [lines]" input: the best lines of the current position, printed as every depth is done
+void Game::showAnalysis(int depth, int lines) const {
+    analyse(*m_chess, depth, lines, [](const search::SearchInfo& info) {
+        std::string text = search::formatInfo(info);
+        std::wcout << std::wstring(text.begin(), text.end()) << std::endl;
+    });
+}
+
 void Game::welcome() const {
     setlocale(LC_CTYPE, "");
     std::wcout << "**********************WELCOME TO CHESS**********************" << std::endl;
 }
 
 void Game::display() const {
-    m_chess->showBoard();
+    m_renderer.render(m_chess->getBoard(), m_chess->getLastMove());
 }
 
 std::pair<std::string, std::string> Game::getMoves(const std::string& move)  const{
-    std::string source; std::string destination;
-    for (int i = 0; i < move.size() - 1; ++i) {
-        if (move[i] == ' ') continue;
-        if (source.empty()) {
-            source.push_back(move[i]);
-            source.push_back(move[i + 1]);
-            ++i;
-        } else {
-            destination.push_back(move[i]);
-            destination.push_back(move[i + 1]);
-            break;
-        }
-    }
-    return {source, destination};
+    return splitMove(move);
 }
 
 bool Game::isValidInput(const std::string& source, const std::string& destination) {
-    if (source.size() != 2 || destination.size() != 2 || source == destination) {
-        return false;
+    return m_chess->isValidInput(source, destination);
+}
+
+// terminal front-end of the session: the board and the prompts on stdout
+class TerminalEvents : public SessionEvents {
+public:
+    explicit TerminalEvents(const Game& game) : m_game(game) {}
+    void prompt(chessPiece::COLOR side, const Chess&) override {
+        m_game.display();
+        std::wcout << (side == chessPiece::COLOR::WHITE ? "white's turn: " : "black's turn: ");
     }
-    if (source[0] < 'a' || source[0] > 'h' || 
-        destination[0] < 'a' || destination[0] > 'h' ||
-        source[1] < '1' || source[1] > '8' ||
-        destination[1] < '1' || destination[1] > '8'){
-        return false;
+    // the output and the prompts of rejected input are under the board, the next board is drawn in full
+    bool command(const SessionInput& input, const Chess&) override {
+        int depth, lines;
+        if (search::parseAnalyse(input.text, depth, lines)) {
+            m_game.showAnalysis(depth, lines);
+        } else if (input.text == "book") {
+            m_game.showBookMoves();
+        } else {
+            return false;
+        }
+        m_game.m_renderer.reset();
+        return true;
     }
-    if (!m_chess->getPieceFromPosition(source)) return false;
-    return true;
-}
+    void rejected(const SessionInput&) override {
+        m_game.m_renderer.reset();
+    }
+    void finished(const std::string& result, Chess::STATUS status) override {
+        m_game.display(); // the final position before the message, it is not redrawn after
+        bool whiteMoved = (result == "1-0") || (status != Chess::STATUS::CHECKMATE && m_game.m_chess->getSideToMove() == chessPiece::COLOR::BLACK);
+        if (status == Chess::STATUS::CHECKMATE) {
+            std::wcout << (whiteMoved ? "White WON!" : "Black WON") << std::endl;
+        } else if (status == Chess::STATUS::STALEMATE) {
+            std::wcout << (whiteMoved ? "Black under stalemate, DRAW!" : "White under stalemate, DRAW!") << std::endl;
+        } else if (status == Chess::STATUS::REPETITION) {
+            std::wcout << "REPETITION: DRAW!" << std::endl;
+        } else if (status == Chess::STATUS::FIFTY_MOVES) {
+            std::wcout << "FIFTY MOVES WITHOUT A CAPTURE OR A PAWN MOVE: DRAW!" << std::endl;
+        } else if (status == Chess::STATUS::INSUFFICIENT_MATERIAL) {
+            std::wcout << "INSUFFICIENT MATERIAL: DRAW!" << std::endl;
+        }
+        m_game.m_renderer.reset();
+    }
+private:
+    const Game& m_game;
+};
 
 void Game::play() {
     welcome();
-    setlocale(LC_CTYPE,"");
     signal(SIGSEGV, handler);
-    bool whiteMove = true;
-    bool blackMove = true;
-    while (true) {
-        while (whiteMove) {
-            std::cin.clear();
-            display();
-            std::wcout << "white's turn: ";
-            std::string move;
-            std::getline(std::cin, move);
-            std::string source; std::string destination;
-            source = getMoves(move).first; destination = getMoves(move).second;
-            if (!isValidInput(source, destination) || !m_chess->isWhiteMoved(source) || !m_chess->isValidMove(source, destination)) {
-                whiteMove = true;
-                m_chess->resetFlags();
-                continue;
-            }
-            whiteMove = true;
-            m_chess->move(source, destination);
-            m_chess->resetFlags();
-            whiteMove = false;
-        }
+    TerminalEvents events(*this);
+    SessionChannel input; // no scheduler: the session runs on this thread
+    SessionTask session = playSession(*m_chess, input, events);
+    std::string move;
+    while (!session.done() && std::getline(std::cin, move)) {
+        input.push({move, std::nullopt});
+    }
+    if (!session.done()) input.close(); // end of input
+    if (!m_archivePath.empty()) {
+        GameArchiveWriter writer(m_archivePath);
+        writer.append("[Result \"" + session.result() + "\"]\n", m_chess->getMoveDB(), archive::toResult(session.result()));
+    }
+}
 
-        if (m_chess->isBlackCheckMated()) {
-            std::wcout << "White WON!" << std::endl;
-            break;
-        }
-        if (m_chess->isBlackStalemate()) {
-            std::wcout << "Black under stalemate, DRAW!" << std::endl;
-            break;
-        }
-        if (m_chess->isRepetition()) {
-            std::wcout << "REPETITION: DRAW!" << std::endl;
-            break;
-        }
+// machine-readable results, no board and no prompts
+class HeadlessEvents : public SessionEvents {
+public:
+    explicit HeadlessEvents(std::ostream& out) : m_out(out) {}
+    bool command(const SessionInput& input, const Chess& chess) override {
+        int depth, lines;
+        if (!search::parseAnalyse(input.text, depth, lines)) return false;
+        analyse(chess, depth, lines, [this](const search::SearchInfo& info) {
+            m_out << search::formatInfo(info) << '\n';
+        });
+        m_out << "analysed" << std::endl;
+        return true;
+    }
+    void accepted(const SessionInput& input, chessPiece::COLOR, Move) override {
+        m_out << "accepted " << input.text << '\n';
+        ++m_plies;
+    }
+    void rejected(const SessionInput& input) override {
+        m_out << "rejected " << input.text << '\n';
+    }
+    void navigated(const SessionInput&, int ply) override {
+        m_out << "ply " << ply << '\n';
+        m_plies = ply;
+    }
+    void finished(const std::string& result, Chess::STATUS status) override {
+        const char* reason = (status == Chess::STATUS::NONE) ? "unfinished" : toString(status);
+        m_out << "result " << result << ' ' << reason << " plies " << m_plies << std::endl;
+    }
+private:
+    std::ostream& m_out;
+    int m_plies = 0;
+};
 
-        while (blackMove) {
-            std::cin.clear();
-            display();
-            std::wcout << "black's turn: ";
-            std::string move;
-            std::getline(std::cin, move);
-            std::string source; std::string destination;
-            source = getMoves(move).first; destination = getMoves(move).second;
-            if (!isValidInput(source, destination) || !m_chess->isBlackMoved(source) || !m_chess->isValidMove(source, destination)) {
-                blackMove = true;
-                m_chess->resetFlags();
-                continue;
-            }
-            m_chess->move(source, destination);
-            m_chess->resetFlags();
-            blackMove = false;
-        }
+// one move per line through the same session as play(), empty lines and '#' comments are skipped.
+// Moves after the end of the game are not read.
+void Game::playHeadless(std::istream& moves, std::ostream& out) {
+    HeadlessEvents events(out);
+    SessionChannel input;
+    SessionTask session = playSession(*m_chess, input, events);
+    std::string move;
+    while (!session.done() && std::getline(moves, move)) {
+        if (!move.empty() && move.back() == '\r') move.pop_back();
+        if (move.empty() || move[0] == '#') continue;
+        input.push({move, std::nullopt});
+    }
+    if (!session.done()) input.close();
+    if (!m_archivePath.empty()) {
+        GameArchiveWriter writer(m_archivePath);
+        writer.append("[Result \"" + session.result() + "\"]\n", m_chess->getMoveDB(), archive::toResult(session.result()));
+    }
+}
 
-        if (m_chess->isWhiteCheckMated()) {
-            std::wcout << "Black WON" << std::endl;
-            break;
+#ifdef CHESS_ALLOC_TRACKING
+// replays one move per line and prints the heap traffic of every ply (validation, move and status check)
+// by scope: "allocations/bytes", then the totals and the peak of the live bytes
+void reportAllocationsPerPly(std::istream& moves, std::ostream& out) {
+    using namespace allocation;
+    Chess chess;
+    std::string move;
+    int ply = 0;
+    Snapshot total;
+    out << "ply move    total       move        isValidMove status      other" << '\n';
+    while (std::getline(moves, move)) {
+        auto [source, destination] = splitMove(move);
+        Snapshot before = snapshot();
+        bool accepted = chess.makeMove(chess.getSideToMove(), source, destination);
+        Chess::STATUS status = accepted ? chess.getStatus(chess.getSideToMove()) : Chess::STATUS::NONE;
+        Snapshot ply_ = snapshot() - before;
+        if (!accepted) {
+            out << "rejected " << move << '\n';
+            continue;
         }
-        if (m_chess->isWhiteStalemate()) {
-            std::wcout << "White under stalemate, DRAW!" << std::endl;
-            break;
+        ++ply;
+        auto cell = [&](std::uint64_t allocations, std::uint64_t bytes) {
+            std::string text = std::to_string(allocations) + "/" + std::to_string(bytes);
+            out << std::left << std::setw(12) << text;
+        };
+        out << std::left << std::setw(4) << ply << std::setw(8) << move;
+        cell(ply_.totalAllocations(), ply_.totalBytes());
+        for (SCOPE scope : {MOVE, IS_VALID_MOVE, STATUS, NONE}) {
+            cell(ply_.allocations[scope], ply_.bytes[scope]);
+            total.allocations[scope] += ply_.allocations[scope];
+            total.bytes[scope] += ply_.bytes[scope];
         }
-        if (m_chess->isRepetition()) {
-            std::wcout << "REPETITION: DRAW!" << std::endl;
-            break;
-        }
-
-        whiteMove = true;
-        blackMove = true;
+        out << '\n';
+        if (status != Chess::STATUS::NONE) break;
     }
-    display();
+    Snapshot last = snapshot();
+    out << std::right << "plies " << ply << ", allocations " << total.totalAllocations() << ", bytes " << total.totalBytes();
+    if (ply) out << ", per ply " << total.totalAllocations() / ply << " allocations " << total.totalBytes() / ply << " bytes";
+    out << ", peak live bytes " << last.peak << std::endl;
 }
+#endif
 
 } // CHESS
\ No newline at end of file
@@ -0,0 +1,303 @@
+/**
+ * @file gameArchive.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Binary container for played and imported games.
+ *
+ *  Layout (native byte order):
+ *   header     : magic, version, index block capacity, game count, first and last index block offsets.
+ *   index block: offset of the next block and a fixed number of IndexEntries (offset, tag bytes, move count, result).
+ *   game record: tag block (the tag lines as text), padded to an even size, followed by the packed Moves.
+ *
+ *  Appending writes the record at the end of the file, fills the next free entry of the last index block
+ *  (a new block is chained at the end when it is full) and finally bumps the game count in the header,
+ *  so nothing written before is ever moved.
+ *
+ *  GameArchive maps the file read-only. Opening walks the index block chain only (every block and record
+ *  is checked to lie in the file, a damaged archive throws), after that
+ *  a game is found with two array lookups and returned as a view into the mapping:
+ *  no copy, and no other game's pages are touched.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef GAMEARCHIVE_H_
+#define GAMEARCHIVE_H_
+
+#include "move.hpp"
+#include <string_view>
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CHESS {
+
+namespace archive {
+
+constexpr char MAGIC[8] = {'C', 'H', 'S', 'G', 'A', 'M', 'E', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t INDEX_BLOCK_CAPACITY = 4096;
+
+enum class RESULT : std::uint8_t { UNKNOWN, WHITE_WON, BLACK_WON, DRAW };
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t indexBlockCapacity;
+    std::uint64_t gameCount;
+    std::uint64_t firstIndexBlock;
+    std::uint64_t lastIndexBlock;
+    std::uint64_t reserved[3];
+};
+
+struct IndexEntry {
+    std::uint64_t offset;
+    std::uint32_t tagBytes;
+    std::uint16_t moveCount;
+    RESULT result;
+    std::uint8_t reserved;
+};
+
+struct IndexBlockHeader {
+    std::uint64_t next;
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(IndexEntry) == 16 && sizeof(IndexBlockHeader) == 16, "On-disk layout");
+
+RESULT toResult(const std::string& result) {
+    if (result == "1-0") return RESULT::WHITE_WON;
+    if (result == "0-1") return RESULT::BLACK_WON;
+    if (result == "1/2-1/2") return RESULT::DRAW;
+    return RESULT::UNKNOWN;
+}
+
+const char* toString(RESULT result) {
+    switch (result) {
+        case RESULT::WHITE_WON: return "1-0";
+        case RESULT::BLACK_WON: return "0-1";
+        case RESULT::DRAW: return "1/2-1/2";
+        default: return "*";
+    }
+}
+
+} // archive
+
+// zero-copy view of one archived game, valid while the GameArchive is not reloaded or destroyed
+struct GameView {
+    std::string_view tags;
+    const Move* moves = nullptr;
+    std::size_t moveCount = 0;
+    archive::RESULT result = archive::RESULT::UNKNOWN;
+
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + moveCount; }
+};
+
+class GameArchiveWriter {
+public:
+    explicit GameArchiveWriter(const std::string& path);
+    GameArchiveWriter(const GameArchiveWriter&) = delete;
+    GameArchiveWriter& operator=(const GameArchiveWriter&) = delete;
+    GameArchiveWriter(GameArchiveWriter&&) = delete;
+    GameArchiveWriter& operator=(GameArchiveWriter&&) = delete;
+    ~GameArchiveWriter();
+
+    std::uint64_t append(std::string_view tags, const Move* moves, std::size_t moveCount, archive::RESULT);
+    std::uint64_t append(std::string_view tags, const std::vector<Move>& moves, archive::RESULT result) {
+        return append(tags, moves.data(), moves.size(), result);
+    }
+    std::uint64_t size() const {
+        return m_header.gameCount;
+    }
+
+private:
+    void write(const void*, std::size_t, std::uint64_t);
+    std::uint64_t allocate(std::size_t);
+
+    int m_fd = -1;
+    archive::Header m_header{};
+    std::uint64_t m_end = 0;
+};
+
+GameArchiveWriter::GameArchiveWriter(const std::string& path) {
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) throw std::runtime_error("Can't open the archive " + path);
+    struct stat st;
+    ::fstat(m_fd, &st);
+    m_end = st.st_size;
+    if (m_end == 0) { // new archive: the header and the first (empty) index block
+        std::memcpy(m_header.magic, archive::MAGIC, sizeof(archive::MAGIC));
+        m_header.version = archive::VERSION;
+        m_header.indexBlockCapacity = archive::INDEX_BLOCK_CAPACITY;
+        m_end = sizeof(archive::Header);
+        m_header.firstIndexBlock = m_header.lastIndexBlock =
+            allocate(sizeof(archive::IndexBlockHeader) + archive::INDEX_BLOCK_CAPACITY * sizeof(archive::IndexEntry));
+        archive::IndexBlockHeader block{};
+        write(&block, sizeof(block), m_header.firstIndexBlock);
+        write(&m_header, sizeof(m_header), 0);
+        return;
+    }
+    if (::pread(m_fd, &m_header, sizeof(m_header), 0) != sizeof(m_header) ||
+        std::memcmp(m_header.magic, archive::MAGIC, sizeof(archive::MAGIC)) != 0 || m_header.version != archive::VERSION) {
+        ::close(m_fd);
+        throw std::runtime_error("Not a game archive " + path);
+    }
+}
+
+GameArchiveWriter::~GameArchiveWriter() {
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+void GameArchiveWriter::write(const void* data, std::size_t size, std::uint64_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (size) {
+        ssize_t written = ::pwrite(m_fd, p, size, offset);
+        if (written <= 0) throw std::runtime_error("Archive write failure");
+        p += written; size -= written; offset += written;
+    }
+}
+
+// reserves 8 byte aligned space at the end of the file
+std::uint64_t GameArchiveWriter::allocate(std::size_t size) {
+    std::uint64_t offset = (m_end + 7) & ~std::uint64_t(7);
+    m_end = offset + size;
+    return offset;
+}
+
+// returns the id of the appended game
+std::uint64_t GameArchiveWriter::append(std::string_view tags, const Move* moves, std::size_t moveCount, archive::RESULT result) {
+    if (moveCount > UINT16_MAX) throw std::logic_error("Too long game for the archive\n");
+    std::size_t tagBytes = tags.size() + (tags.size() & 1); // moves are 2 byte aligned
+    std::vector<char> record(tagBytes + moveCount * sizeof(Move), 0);
+    std::memcpy(record.data(), tags.data(), tags.size());
+    std::memcpy(record.data() + tagBytes, moves, moveCount * sizeof(Move));
+    archive::IndexEntry entry{allocate(record.size()), static_cast<std::uint32_t>(tags.size()),
+                              static_cast<std::uint16_t>(moveCount), result, 0};
+    write(record.data(), record.size(), entry.offset);
+
+    const std::uint64_t id = m_header.gameCount;
+    const std::uint32_t slot = id % m_header.indexBlockCapacity;
+    if (id && !slot) { // the last block is full, chain a new one
+        archive::IndexBlockHeader block{};
+        std::uint64_t blockOffset = allocate(sizeof(block) + m_header.indexBlockCapacity * sizeof(archive::IndexEntry));
+        write(&block, sizeof(block), blockOffset);
+        write(&blockOffset, sizeof(blockOffset), m_header.lastIndexBlock); // next of the previous block
+        m_header.lastIndexBlock = blockOffset;
+    }
+    write(&entry, sizeof(entry), m_header.lastIndexBlock + sizeof(archive::IndexBlockHeader) + slot * sizeof(entry));
+    ++m_header.gameCount; // the count is written last, a partially appended game is never visible
+    write(&m_header, sizeof(m_header), 0);
+    return id;
+}
+
+class GameArchive {
+public:
+    explicit GameArchive(const std::string& path);
+    GameArchive(const GameArchive&) = delete;
+    GameArchive& operator=(const GameArchive&) = delete;
+    GameArchive(GameArchive&&) = delete;
+    GameArchive& operator=(GameArchive&&) = delete;
+    ~GameArchive();
+
+    void reload();
+    std::uint64_t size() const {
+        return m_gameCount;
+    }
+    GameView operator[](std::uint64_t id) const {
+        const archive::IndexEntry& entry = m_blocks[id / m_capacity][id % m_capacity];
+        const char* record = m_data + entry.offset;
+        return { std::string_view(record, entry.tagBytes),
+                 reinterpret_cast<const Move*>(record + entry.tagBytes + (entry.tagBytes & 1)),
+                 entry.moveCount, entry.result };
+    }
+    GameView at(std::uint64_t id) const {
+        if (id >= m_gameCount) throw std::out_of_range("No such game in the archive");
+        return (*this)[id];
+    }
+
+private:
+    void unmap();
+
+    std::string m_path;
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::uint64_t m_gameCount = 0;
+    std::uint32_t m_capacity = 0;
+    std::vector<const archive::IndexEntry*> m_blocks;
+};
+
+GameArchive::GameArchive(const std::string& path) : m_path(path) {
+    reload();
+}
+
+GameArchive::~GameArchive() {
+    unmap();
+}
+
+void GameArchive::unmap() {
+    if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_blocks.clear();
+}
+
+// maps the file again, picks up games appended after the previous mapping
+void GameArchive::reload() {
+    unmap();
+    int fd = ::open(m_path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Can't open the archive " + m_path);
+    struct stat st;
+    ::fstat(fd, &st);
+    m_size = st.st_size;
+    if (m_size < sizeof(archive::Header)) {
+        ::close(fd);
+        throw std::runtime_error("Not a game archive " + m_path);
+    }
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("Can't map the archive " + m_path);
+    m_data = static_cast<const char*>(data);
+    ::madvise(data, m_size, MADV_RANDOM); // no read-ahead, a lookup touches only its own pages
+
+    const archive::Header* header = reinterpret_cast<const archive::Header*>(m_data);
+    if (std::memcmp(header->magic, archive::MAGIC, sizeof(archive::MAGIC)) != 0 || header->version != archive::VERSION) {
+        unmap();
+        throw std::runtime_error("Not a game archive " + m_path);
+    }
+    // every block and every record must lie in the file, operator[] doesn't check anything
+    auto fits = [this](std::uint64_t offset, std::uint64_t size) {
+        return offset >= sizeof(archive::Header) && offset <= m_size && size <= m_size - offset;
+    };
+    auto corrupt = [this]() {
+        unmap();
+        throw std::runtime_error("Corrupt game archive " + m_path);
+    };
+    m_gameCount = header->gameCount;
+    m_capacity = header->indexBlockCapacity;
+    if (!m_capacity || m_capacity > m_size / sizeof(archive::IndexEntry)) corrupt();
+    const std::uint64_t blockBytes = sizeof(archive::IndexBlockHeader) + std::uint64_t(m_capacity) * sizeof(archive::IndexEntry);
+    if (m_gameCount / m_capacity > m_size / blockBytes) corrupt(); // more blocks than the file can hold
+    std::uint64_t blockOffset = header->firstIndexBlock;
+    for (std::uint64_t i = 0; i < m_gameCount; i += m_capacity) {
+        if (blockOffset % alignof(archive::IndexBlockHeader) || !fits(blockOffset, blockBytes)) corrupt();
+        const archive::IndexEntry* entries = reinterpret_cast<const archive::IndexEntry*>(m_data + blockOffset + sizeof(archive::IndexBlockHeader));
+        for (std::uint64_t slot = 0; slot < m_capacity && i + slot < m_gameCount; ++slot) {
+            const archive::IndexEntry& entry = entries[slot];
+            const std::uint64_t tagBytes = std::uint64_t(entry.tagBytes) + (entry.tagBytes & 1);
+            if (entry.offset % alignof(Move) || !fits(entry.offset, tagBytes + std::uint64_t(entry.moveCount) * sizeof(Move))) corrupt();
+        }
+        m_blocks.push_back(entries);
+        blockOffset = reinterpret_cast<const archive::IndexBlockHeader*>(m_data + blockOffset)->next;
+    }
+}
+
+} // CHESS
+
+#endif
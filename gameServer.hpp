@@ -0,0 +1,589 @@
+/**
+ * @file gameServer.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Multi-session game server: one epoll event loop serves all connections on a local TCP port
+ *  or a Unix socket, every session (game) owns its Chess.
+ *
+ *  Line protocol (one command per line, one or more reply lines):
+ *   new              -> "game <id> white", the creator plays both sides until somebody joins
+ *   join <id>        -> "game <id> black", the creator gets "joined <id>"
+ *                       (new and join leave the game the connection was in, as quit does)
+ *   move <e2e4>      -> "ok e2e4" or "illegal e2e4", the opponent gets "moved e2e4",
+ *                       "end <result> <reason>" goes to both players when the game is over
+ *   move takeback | redo | goto <N> -> "ply <N>" (the creator alone, before somebody joins), else "illegal ..."
+ *   analyse [depth] [lines] -> "info depth ..." lines (search::formatInfo) as the search deepens, then "analysed",
+ *                       at most MAX_ANALYSIS_DEPTH and MAX_ANALYSIS_LINES. The session hands a Position snapshot
+ *                       to the analysis threads, which are not the session workers: a search never delays a move.
+ *   stats            -> move round-trip latency percentiles in microseconds
+ *   quit             -> closes the connection, the opponent gets "left"
+ *
+ *  Every game is a playSession coroutine (gameSession.hpp) resumed on a small SessionScheduler pool,
+ *  the I/O thread only parses lines and writes replies. Session events come back through an eventfd completion queue.
+ *  The Chess and the coroutine of a session are created with the first move, so a game waiting for players costs only the Session.
+ *  The round-trip latency is measured from reading the line to queuing the reply.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef GAMESERVER_H_
+#define GAMESERVER_H_
+
+#include "chess.hpp"
+#include "gameSession.hpp"
+#include "search.hpp"
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <unordered_map>
+#include <sstream>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace CHESS {
+
+class LatencyRecorder {
+public:
+    void record(std::uint32_t micros) {
+        if (m_samples.size() < MAX_SAMPLES) {
+            m_samples.push_back(micros);
+        } else {
+            m_samples[m_next++ % MAX_SAMPLES] = micros; // keeps the last MAX_SAMPLES
+        }
+    }
+    std::string report() const;
+
+private:
+    static constexpr std::size_t MAX_SAMPLES = 1 << 20;
+    std::vector<std::uint32_t> m_samples;
+    std::size_t m_next = 0;
+};
+
+std::string LatencyRecorder::report() const {
+    std::ostringstream out;
+    out << "stats moves " << m_samples.size();
+    if (m_samples.empty()) return out.str();
+    std::vector<std::uint32_t> sorted = m_samples;
+    std::sort(sorted.begin(), sorted.end());
+    for (double p : {50.0, 90.0, 99.0, 99.9}) {
+        out << " p" << p << " " << sorted[static_cast<std::size_t>(p / 100 * (sorted.size() - 1))];
+    }
+    out << " max " << sorted.back();
+    return out.str();
+}
+
+class GameServer {
+public:
+    static constexpr int MAX_ANALYSIS_DEPTH = 5;
+    static constexpr int MAX_ANALYSIS_LINES = 4;
+
+    explicit GameServer(const std::string& address, unsigned workers = 2, unsigned analysisThreads = 1);
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+    GameServer(GameServer&&) = delete;
+    GameServer& operator=(GameServer&&) = delete;
+    ~GameServer();
+
+    void run();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        std::uint32_t session = 0;
+        chessPiece::COLOR color = chessPiece::COLOR::WHITE;
+        bool writing = false; // EPOLLOUT is registered
+    };
+
+    // forwards the session events of a worker to the I/O thread
+    class ServerEvents : public SessionEvents {
+    public:
+        ServerEvents(GameServer& server, std::uint32_t id) : m_server(server), m_id(id) {}
+        bool command(const SessionInput& input, const Chess& chess) override {
+            int depth, lines;
+            if (!search::parseAnalyse(input.text, depth, lines)) return false;
+            m_server.m_analysis->submit({m_id, input, chess.getPosition(), std::min(depth, MAX_ANALYSIS_DEPTH), std::min(lines, MAX_ANALYSIS_LINES)});
+            return true;
+        }
+        void accepted(const SessionInput& input, chessPiece::COLOR, Move) override {
+            m_server.complete({m_id, Completion::KIND::ACCEPTED, input, ""});
+        }
+        void rejected(const SessionInput& input) override {
+            m_server.complete({m_id, Completion::KIND::REJECTED, input, ""});
+        }
+        void navigated(const SessionInput& input, int ply) override {
+            m_server.complete({m_id, Completion::KIND::NAVIGATED, input, "ply " + std::to_string(ply)});
+        }
+        void finished(const std::string& result, Chess::STATUS status) override {
+            std::string reason = (status == Chess::STATUS::NONE) ? "aborted" : toString(status);
+            m_server.complete({m_id, Completion::KIND::FINISHED, SessionInput{}, "end " + result + " " + reason});
+        }
+    private:
+        GameServer& m_server;
+        std::uint32_t m_id;
+    };
+
+    // the analyses run on their own threads, the session workers only validate moves
+    class AnalysisPool {
+    public:
+        struct Job {
+            std::uint32_t session;
+            SessionInput input;
+            Position position;
+            int depth;
+            int lines;
+        };
+
+        AnalysisPool(GameServer& server, unsigned threads);
+        AnalysisPool(const AnalysisPool&) = delete;
+        AnalysisPool& operator=(const AnalysisPool&) = delete;
+        AnalysisPool(AnalysisPool&&) = delete;
+        AnalysisPool& operator=(AnalysisPool&&) = delete;
+        ~AnalysisPool(); // the queued jobs are dropped, the running ones finish
+
+        void submit(Job job);
+
+    private:
+        void worker();
+
+        GameServer& m_server;
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::deque<Job> m_queue;
+        bool m_stopping = false;
+        std::vector<std::thread> m_threads;
+    };
+
+    struct Running {
+        Running(GameServer& server, std::uint32_t id) : input(server.m_scheduler.get()), events(server, id) {
+            task = playSession(chess, input, events);
+        }
+        Chess chess;
+        SessionChannel input;
+        ServerEvents events;
+        SessionTask task;
+    };
+
+    struct Session {
+        int white = -1;
+        int black = -1;
+        std::unique_ptr<Running> game;
+        std::deque<std::pair<Clock::time_point, SessionInput>> received; // the moves not answered yet, in order
+        bool over = false;
+    };
+
+    struct Completion {
+        enum class KIND { ACCEPTED, REJECTED, NAVIGATED, FINISHED, ANALYSIS };
+        Completion(std::uint32_t session, KIND kind, SessionInput input, std::string text)
+            : session(session), kind(kind), input(std::move(input)), text(std::move(text)) {}
+        std::uint32_t session;
+        KIND kind;
+        SessionInput input;
+        std::string text;
+    };
+
+    void listen(const std::string& address);
+    void accept();
+    void read(Connection&);
+    void flush(Connection&);
+    void send(int fd, const std::string& line);
+    void close(int fd);
+    void leave(int fd, std::uint32_t session);
+    void handleLine(Connection&, const std::string& line);
+    void complete(Completion completion);
+    void completions();
+    int sender(const Session&, const SessionInput&) const;
+
+    int m_listenFd = -1;
+    int m_epollFd = -1;
+    int m_eventFd = -1;
+    int m_signalFd = -1;
+    std::string m_unixPath;
+
+    std::unordered_map<int, Connection> m_connections;
+    std::unordered_map<std::uint32_t, Session> m_sessions;
+    std::uint32_t m_nextSession = 1;
+    LatencyRecorder m_latency;
+
+    std::mutex m_mutex;
+    std::vector<Completion> m_completions;
+    std::unique_ptr<AnalysisPool> m_analysis;
+    std::unique_ptr<SessionScheduler> m_scheduler; // destroyed first, no session runs after it
+};
+
+GameServer::AnalysisPool::AnalysisPool(GameServer& server, unsigned threads) : m_server(server) {
+    if (!threads) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&AnalysisPool::worker, this);
+    }
+}
+
+GameServer::AnalysisPool::~AnalysisPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_ready.notify_all();
+    for (auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void GameServer::AnalysisPool::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(job));
+    }
+    m_ready.notify_one();
+}
+
+void GameServer::AnalysisPool::worker() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_ready.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) return;
+        Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        search::Search search;
+        search.analyse(job.position, job.depth, job.lines, [this, &job](const search::SearchInfo& info) {
+            m_server.complete({job.session, Completion::KIND::ANALYSIS, job.input, search::formatInfo(info)});
+        });
+        m_server.complete({job.session, Completion::KIND::ANALYSIS, job.input, "analysed"});
+    }
+}
+
+GameServer::GameServer(const std::string& address, unsigned workers, unsigned analysisThreads) {
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    ::pthread_sigmask(SIG_BLOCK, &signals, nullptr); // before the workers start, they inherit the mask
+    m_signalFd = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    ::signal(SIGPIPE, SIG_IGN);
+    if (m_epollFd < 0 || m_eventFd < 0 || m_signalFd < 0) throw std::runtime_error("Can't create the event loop");
+    listen(address);
+    for (int fd : {m_listenFd, m_eventFd, m_signalFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+    m_analysis = std::make_unique<AnalysisPool>(*this, analysisThreads);
+    m_scheduler = std::make_unique<SessionScheduler>(workers);
+}
+
+GameServer::~GameServer() {
+    m_scheduler.reset();
+    m_analysis.reset();
+    for (auto& connection : m_connections) {
+        ::close(connection.first);
+    }
+    for (int fd : {m_listenFd, m_epollFd, m_eventFd, m_signalFd}) {
+        if (fd >= 0) ::close(fd);
+    }
+    if (!m_unixPath.empty()) ::unlink(m_unixPath.c_str());
+}
+
+// "unix:/path/to/socket" or a TCP port on the loopback interface
+void GameServer::listen(const std::string& address) {
+    if (address.rfind("unix:", 0) == 0) {
+        m_unixPath = address.substr(5);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, m_unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(m_unixPath.c_str());
+        m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::runtime_error("Can't bind " + address);
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(std::stoi(address)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        m_listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::runtime_error("Can't bind port " + address);
+        }
+    }
+    if (::listen(m_listenFd, SOMAXCONN) < 0) throw std::runtime_error("Can't listen on " + address);
+}
+
+// serves until SIGINT or SIGTERM, then prints the latency report
+void GameServer::run() {
+    std::vector<epoll_event> events(256);
+    while (true) {
+        int n = ::epoll_wait(m_epollFd, events.data(), events.size(), -1);
+        if (n < 0 && errno == EINTR) continue;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == m_signalFd) {
+                std::cout << m_latency.report() << std::endl;
+                return;
+            }
+            if (fd == m_listenFd) {
+                accept();
+            } else if (fd == m_eventFd) {
+                std::uint64_t value;
+                while (::read(m_eventFd, &value, sizeof(value)) > 0) {}
+                completions();
+            } else {
+                auto iter = m_connections.find(fd);
+                if (iter == m_connections.end()) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    close(fd);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) flush(iter->second);
+                if (events[i].events & EPOLLIN) read(iter->second);
+            }
+        }
+    }
+}
+
+void GameServer::accept() {
+    while (true) {
+        int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly for Unix sockets
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+        m_connections[fd].fd = fd;
+    }
+}
+
+void GameServer::read(Connection& connection) {
+    const int fd = connection.fd;
+    char buffer[4096];
+    while (true) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            close(fd);
+            return;
+        }
+        if (n < 0) break;
+        connection.in.append(buffer, n);
+    }
+    std::size_t start = 0;
+    std::size_t end;
+    while ((end = connection.in.find('\n', start)) != std::string::npos) {
+        std::string line = connection.in.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        handleLine(connection, line);
+        if (!m_connections.count(fd)) return; // closed by the command
+    }
+    connection.in.erase(0, start);
+}
+
+void GameServer::send(int fd, const std::string& line) {
+    auto iter = m_connections.find(fd);
+    if (iter == m_connections.end()) return;
+    iter->second.out += line;
+    iter->second.out.push_back('\n');
+    flush(iter->second);
+}
+
+void GameServer::flush(Connection& connection) {
+    while (!connection.out.empty()) {
+        ssize_t n = ::write(connection.fd, connection.out.data(), connection.out.size());
+        if (n <= 0) break;
+        connection.out.erase(0, n);
+    }
+    bool writing = !connection.out.empty();
+    if (writing != connection.writing) { // wait for the socket only while there is something to write
+        epoll_event event{};
+        event.events = EPOLLIN | (writing ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = connection.fd;
+        ::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.writing = writing;
+    }
+}
+
+void GameServer::close(int fd) {
+    auto iter = m_connections.find(fd);
+    if (iter == m_connections.end()) return;
+    std::uint32_t id = iter->second.session;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    m_connections.erase(iter);
+    leave(fd, id);
+}
+
+// the player of fd is out of the session: the opponent gets "left", a session without players ends
+void GameServer::leave(int fd, std::uint32_t id) {
+    auto sessionIter = m_sessions.find(id);
+    if (sessionIter == m_sessions.end()) return;
+    Session& session = sessionIter->second;
+    if (session.white != fd && session.black != fd) return;
+    if (session.white == fd) session.white = -1;
+    if (session.black == fd) session.black = -1;
+    int other = (session.white >= 0) ? session.white : session.black;
+    if (other >= 0) {
+        send(other, "left");
+    } else if (!session.game || session.over) {
+        if (session.game) session.game->task.wait();
+        m_sessions.erase(sessionIter);
+    } else {
+        session.game->input.close(); // erased when the session reports its end
+    }
+}
+
+void GameServer::handleLine(Connection& connection, const std::string& line) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+    if (command == "new") {
+        leave(connection.fd, connection.session); // a connection plays one game at a time
+        std::uint32_t id = m_nextSession++;
+        m_sessions[id].white = connection.fd;
+        connection.session = id;
+        connection.color = chessPiece::COLOR::WHITE;
+        send(connection.fd, "game " + std::to_string(id) + " white");
+    } else if (command == "join") {
+        std::uint32_t id = 0;
+        in >> id;
+        auto iter = m_sessions.find(id);
+        if (iter == m_sessions.end() || iter->second.black >= 0 || iter->second.white == connection.fd) {
+            send(connection.fd, "error no such game");
+            return;
+        }
+        leave(connection.fd, connection.session);
+        iter->second.black = connection.fd;
+        connection.session = id;
+        connection.color = chessPiece::COLOR::BLACK;
+        send(connection.fd, "game " + std::to_string(id) + " black");
+        if (iter->second.white >= 0) send(iter->second.white, "joined " + std::to_string(id));
+    } else if (command == "move") {
+        auto iter = m_sessions.find(connection.session);
+        if (iter == m_sessions.end()) {
+            send(connection.fd, "error no game");
+            return;
+        }
+        Session& session = iter->second;
+        std::string move, ply;
+        in >> move;
+        if (move == "goto" && in >> ply) move += " " + ply;
+        if (session.over) {
+            send(connection.fd, "illegal " + move);
+            return;
+        }
+        if (!session.game) session.game = std::make_unique<Running>(*this, connection.session);
+        // the creator plays both sides until the opponent joins
+        std::optional<chessPiece::COLOR> player;
+        if (session.black >= 0) player = connection.color;
+        session.received.emplace_back(Clock::now(), SessionInput{move, player});
+        session.game->input.push({move, player});
+    } else if (command == "analyse") {
+        auto iter = m_sessions.find(connection.session);
+        if (iter == m_sessions.end() || iter->second.over) {
+            send(connection.fd, "error no game");
+            return;
+        }
+        Session& session = iter->second;
+        if (!session.game) session.game = std::make_unique<Running>(*this, connection.session);
+        session.game->input.push({line, connection.color}); // the color only addresses the reply
+    } else if (command == "stats") {
+        send(connection.fd, m_latency.report());
+    } else if (command == "quit") {
+        close(connection.fd);
+    } else if (!command.empty()) {
+        send(connection.fd, "error unknown command");
+    }
+}
+
+// called by the session on a worker
+void GameServer::complete(Completion completion) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_completions.push_back(std::move(completion));
+    }
+    std::uint64_t one = 1;
+    ::write(m_eventFd, &one, sizeof(one));
+}
+
+// the connection which sent the move, the creator in a game without an opponent
+int GameServer::sender(const Session& session, const SessionInput& input) const {
+    return (input.player == chessPiece::COLOR::BLACK) ? session.black : session.white;
+}
+
+void GameServer::completions() {
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_completions);
+    }
+    for (Completion& completion : done) {
+        auto iter = m_sessions.find(completion.session);
+        if (iter == m_sessions.end()) continue;
+        Session& session = iter->second;
+        if (completion.kind == Completion::KIND::FINISHED) {
+            session.over = true;
+            if (session.white < 0 && session.black < 0) { // both players left
+                session.game->task.wait();
+                m_sessions.erase(iter);
+                continue;
+            }
+            for (int fd : {session.white, session.black}) {
+                if (fd >= 0) send(fd, completion.text);
+            }
+            for (const auto& pending : session.received) { // queued after the last move, the session didn't read them
+                int fd = sender(session, pending.second);
+                if (fd >= 0) send(fd, "illegal " + pending.second.text);
+            }
+            session.received.clear();
+            continue;
+        }
+        if (completion.kind == Completion::KIND::ANALYSIS) {
+            send(sender(session, completion.input), completion.text);
+            continue;
+        }
+        m_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - session.received.front().first).count());
+        session.received.pop_front();
+        int fd = sender(session, completion.input);
+        const std::string& move = completion.input.text;
+        if (completion.kind == Completion::KIND::NAVIGATED) {
+            send(fd, completion.text);
+            continue;
+        }
+        if (completion.kind == Completion::KIND::REJECTED) {
+            send(fd, "illegal " + move);
+            continue;
+        }
+        send(fd, "ok " + move);
+        int other = (fd == session.white) ? session.black : session.white;
+        if (other >= 0) send(other, "moved " + move);
+    }
+}
+
+} // CHESS
+
+#endif
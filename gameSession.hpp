@@ -0,0 +1,331 @@
+/**
+ * @file gameSession.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Game sessions as C++20 coroutines.
+ *  playSession is the human vs human flow (the side to move gives a move, it is validated, the status is checked)
+ *  written once for every front-end: the terminal Game, the GameServer and scripted tests.
+ *  The session co_awaits its next input from a SessionChannel and reports through SessionEvents.
+ *
+ *  A session waiting for input is a suspended coroutine frame, it holds no thread.
+ *  SessionChannel::push resumes the waiting session on the SessionScheduler worker pool,
+ *  or right on the pushing thread if the channel has no scheduler (the terminal game, tests).
+ *  A session runs on one thread at a time, the events are called from that thread.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef GAMESESSION_H_
+#define GAMESESSION_H_
+
+#include "chess.hpp"
+#include "san.hpp"
+#include "timeline.hpp"
+#include <coroutine>
+#include <utility>
+#include <optional>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace CHESS {
+
+struct SessionInput {
+    std::string text;
+    std::optional<chessPiece::COLOR> player; // empty: the move is for the side to move (one player at the keyboard)
+};
+
+// "e2e4" or "e2 e4" -> {"e2", "e4"}, empty strings if the input is too short
+std::pair<std::string, std::string> splitMove(const std::string& move) {
+    std::string squares;
+    for (char c : move) {
+        if (c != ' ') squares.push_back(c);
+    }
+    if (squares.size() < 4) return {"", ""};
+    return {squares.substr(0, 2), squares.substr(2, 2)};
+}
+
+class SessionScheduler {
+public:
+    explicit SessionScheduler(unsigned threads = 2);
+    SessionScheduler(const SessionScheduler&) = delete;
+    SessionScheduler& operator=(const SessionScheduler&) = delete;
+    SessionScheduler(SessionScheduler&&) = delete;
+    SessionScheduler& operator=(SessionScheduler&&) = delete;
+    ~SessionScheduler();
+
+    void schedule(std::coroutine_handle<> handle);
+
+private:
+    void worker();
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<std::coroutine_handle<>> m_queue;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+SessionScheduler::SessionScheduler(unsigned threads) {
+    if (!threads) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&SessionScheduler::worker, this);
+    }
+}
+
+// queued sessions are not resumed, they are destroyed with their tasks
+SessionScheduler::~SessionScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_ready.notify_all();
+    for (auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void SessionScheduler::schedule(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(handle);
+    }
+    m_ready.notify_one();
+}
+
+void SessionScheduler::worker() {
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            handle = m_queue.front();
+            m_queue.pop_front();
+        }
+        handle.resume();
+    }
+}
+
+class SessionChannel {
+public:
+    explicit SessionChannel(SessionScheduler* p_scheduler = nullptr) : m_scheduler(p_scheduler) {}
+    SessionChannel(const SessionChannel&) = delete;
+    SessionChannel& operator=(const SessionChannel&) = delete;
+    SessionChannel(SessionChannel&&) = delete;
+    SessionChannel& operator=(SessionChannel&&) = delete;
+    ~SessionChannel() = default;
+
+    void push(SessionInput input);
+    void close(); // the session gets an empty input and ends
+
+    class Awaiter {
+    public:
+        explicit Awaiter(SessionChannel& channel) : m_channel(channel) {}
+        bool await_ready() {
+            std::lock_guard<std::mutex> lock(m_channel.m_mutex);
+            return m_channel.m_closed || !m_channel.m_inputs.empty();
+        }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(m_channel.m_mutex);
+            if (m_channel.m_closed || !m_channel.m_inputs.empty()) return false; // arrived after await_ready
+            m_channel.m_waiting = handle;
+            return true;
+        }
+        std::optional<SessionInput> await_resume() {
+            std::lock_guard<std::mutex> lock(m_channel.m_mutex);
+            if (m_channel.m_inputs.empty()) return std::nullopt;
+            SessionInput input = std::move(m_channel.m_inputs.front());
+            m_channel.m_inputs.pop_front();
+            return input;
+        }
+    private:
+        SessionChannel& m_channel;
+    };
+
+    Awaiter next() {
+        return Awaiter(*this);
+    }
+
+private:
+    void wake(std::coroutine_handle<> handle);
+
+    SessionScheduler* m_scheduler;
+    std::mutex m_mutex;
+    std::deque<SessionInput> m_inputs;
+    std::coroutine_handle<> m_waiting;
+    bool m_closed = false;
+};
+
+void SessionChannel::push(SessionInput input) {
+    std::coroutine_handle<> waiting;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inputs.push_back(std::move(input));
+        std::swap(waiting, m_waiting);
+    }
+    if (waiting) wake(waiting);
+}
+
+void SessionChannel::close() {
+    std::coroutine_handle<> waiting;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        std::swap(waiting, m_waiting);
+    }
+    if (waiting) wake(waiting);
+}
+
+void SessionChannel::wake(std::coroutine_handle<> handle) {
+    if (m_scheduler) {
+        m_scheduler->schedule(handle);
+    } else {
+        handle.resume();
+    }
+}
+
+// the coroutine of a session, started eagerly: it runs up to its first co_await on the creating thread
+class SessionTask {
+public:
+    struct promise_type {
+        std::string result = "*";
+        std::atomic<bool> finished{false};
+
+        SessionTask get_return_object() {
+            return SessionTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept {
+                    return false;
+                }
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    // set only once suspended, the owner may destroy the frame as soon as it sees the flag
+                    handle.promise().finished.store(true, std::memory_order_release);
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+        void return_value(std::string value) {
+            result = std::move(value);
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+    SessionTask() = default;
+    SessionTask(const SessionTask&) = delete;
+    SessionTask& operator=(const SessionTask&) = delete;
+    SessionTask(SessionTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    SessionTask& operator=(SessionTask&& other) noexcept;
+    ~SessionTask();
+
+    bool done() const {
+        return m_handle && m_handle.promise().finished.load(std::memory_order_acquire);
+    }
+    // for a session finishing on a worker: it is past its last event, this is a short wait
+    void wait() const {
+        while (m_handle && !done()) std::this_thread::yield();
+    }
+    // "1-0", "0-1", "1/2-1/2" or "*", valid once done
+    const std::string& result() const {
+        return m_handle.promise().result;
+    }
+
+private:
+    explicit SessionTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+SessionTask& SessionTask::operator=(SessionTask&& other) noexcept {
+    if (this != &other) {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+}
+
+// the session must be finished or suspended (not running on a worker)
+SessionTask::~SessionTask() {
+    if (m_handle) m_handle.destroy();
+}
+
+// the reason of the end of a game in the front-end outputs, empty for STATUS::NONE
+const char* toString(Chess::STATUS status) {
+    switch (status) {
+        case Chess::STATUS::CHECKMATE: return "checkmate";
+        case Chess::STATUS::STALEMATE: return "stalemate";
+        case Chess::STATUS::REPETITION: return "repetition";
+        case Chess::STATUS::FIFTY_MOVES: return "fifty-moves";
+        case Chess::STATUS::INSUFFICIENT_MATERIAL: return "insufficient-material";
+        default: return "";
+    }
+}
+
+class SessionEvents {
+public:
+    virtual ~SessionEvents() = default;
+    virtual void prompt(chessPiece::COLOR /*side*/, const Chess&) {}
+    virtual bool command(const SessionInput&, const Chess&) { // front-end commands ("book", "analyse"), true if handled
+        return false;
+    }
+    virtual void accepted(const SessionInput&, chessPiece::COLOR /*side*/, Move) {}
+    virtual void rejected(const SessionInput&) {}
+    virtual void navigated(const SessionInput&, int /*ply*/) {} // after "takeback", "redo" or "goto N"
+    virtual void finished(const std::string& /*result*/, Chess::STATUS) {}
+};
+
+// STATUS::NONE in finished() means the input was closed before the end of the game.
+// Takeback, redo and goto are for one player at the keyboard, a player of a two player session can't undo a move.
+SessionTask playSession(Chess& chess, SessionChannel& input, SessionEvents& events) {
+    Timeline timeline(chess);
+    while (true) {
+        const chessPiece::COLOR side = chess.getSideToMove();
+        events.prompt(side, chess);
+        std::optional<SessionInput> line = co_await input.next();
+        if (!line) {
+            events.finished("*", Chess::STATUS::NONE);
+            co_return "*";
+        }
+        if (events.command(*line, chess)) continue;
+        if (int ply; timeline.parse(line->text, ply)) {
+            if (line->player || !timeline.seek(ply)) {
+                events.rejected(*line);
+            } else {
+                events.navigated(*line, ply);
+            }
+            continue;
+        }
+        Move move = san::parseInput(chess, line->text);
+        if ((line->player && *line->player != side) || move.isNull() || !chess.makeMove(side, move)) {
+            events.rejected(*line);
+            continue;
+        }
+        timeline.record(chess.getLastMove());
+        events.accepted(*line, side, chess.getLastMove());
+
+        Chess::STATUS status = chess.getStatus(chess.getSideToMove());
+        if (status != Chess::STATUS::NONE) {
+            std::string result = (status != Chess::STATUS::CHECKMATE) ? "1/2-1/2" : (side == chessPiece::COLOR::WHITE ? "1-0" : "0-1");
+            events.finished(result, status);
+            co_return result;
+        }
+    }
+}
+
+} // CHESS
+
+#endif
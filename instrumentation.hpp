@@ -0,0 +1,171 @@
+/**
+ * @file instrumentation.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Hot path counters and timers, compiled in with -DCHESS_INSTRUMENTATION only.
+ *  CHESS_INSTRUMENT(COUNTER) at the top of a function counts the call and adds its time (steady_clock,
+ *  inclusive of nested instrumented calls). Without the define the macro is empty and nothing else is compiled.
+ *
+ *  Every thread counts into its own block of relaxed atomics, the blocks are chained in a lock-free list
+ *  and stay alive after their thread ends, so the totals include finished threads.
+ *  The totals are printed at exit: a table to stderr, or JSON to the file named by CHESS_INSTRUMENTATION_JSON.
+ *  SIGUSR1 prints the table while the program runs.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+#ifdef CHESS_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <csignal>
+#include <fstream>
+#include <unistd.h>
+
+namespace CHESS {
+
+namespace instrumentation {
+
+enum COUNTER { IS_VALID_MOVE, GET_ATTACKING_SQUARES, GET_ATTACKING_PATH, IS_SQUARE_OCCUPIED, GET_PIECE_FROM_POSITION, COUNTER_COUNT };
+
+constexpr const char* NAMES[COUNTER_COUNT] = {"isValidMove", "getAttackingSquares", "getAttackingPath", "isSquareOccupied", "getPieceFromPosition"};
+
+struct ThreadCounters {
+    std::atomic<std::uint64_t> calls[COUNTER_COUNT] = {};
+    std::atomic<std::uint64_t> nanoseconds[COUNTER_COUNT] = {};
+    ThreadCounters* next = nullptr;
+};
+
+inline std::atomic<ThreadCounters*> g_threads{nullptr};
+
+inline ThreadCounters& threadCounters() {
+    thread_local ThreadCounters* p_counters = [] {
+        ThreadCounters* p_new = new ThreadCounters(); // never freed, read after the thread ends
+        p_new->next = g_threads.load(std::memory_order_relaxed);
+        while (!g_threads.compare_exchange_weak(p_new->next, p_new, std::memory_order_release, std::memory_order_relaxed)) {}
+        return p_new;
+    }();
+    return *p_counters;
+}
+
+class Scope {
+public:
+    explicit Scope(COUNTER counter) : m_counter(counter), m_start(std::chrono::steady_clock::now()) {}
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(Scope&&) = delete;
+    ~Scope() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        ThreadCounters& counters = threadCounters(); // only this thread writes, a plain load and store is enough
+        counters.calls[m_counter].store(counters.calls[m_counter].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.nanoseconds[m_counter].store(counters.nanoseconds[m_counter].load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    }
+
+private:
+    COUNTER m_counter;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+struct Totals {
+    std::uint64_t calls[COUNTER_COUNT] = {};
+    std::uint64_t nanoseconds[COUNTER_COUNT] = {};
+    std::uint64_t threads = 0;
+};
+
+inline Totals totals() {
+    Totals result;
+    for (ThreadCounters* p = g_threads.load(std::memory_order_acquire); p; p = p->next) {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            result.calls[i] += p->calls[i].load(std::memory_order_relaxed);
+            result.nanoseconds[i] += p->nanoseconds[i].load(std::memory_order_relaxed);
+        }
+        ++result.threads;
+    }
+    return result;
+}
+
+// no allocation and no stdio: used from the signal handler
+inline void appendNumber(char*& p, std::uint64_t value, int width) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = n; i < width; ++i) *p++ = ' ';
+    while (n) *p++ = digits[--n];
+}
+
+inline void appendText(char*& p, const char* text, int width) {
+    int n = 0;
+    for (; text[n]; ++n) *p++ = text[n];
+    for (; n < width; ++n) *p++ = ' ';
+}
+
+inline void writeTable(int fd) {
+    Totals t = totals();
+    char buffer[2048];
+    char* p = buffer;
+    appendText(p, "counter", 22);
+    appendText(p, "               calls            total us         ns/call\n", 0);
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        appendText(p, NAMES[i], 22);
+        appendNumber(p, t.calls[i], 20);
+        appendNumber(p, t.nanoseconds[i] / 1000, 20);
+        appendNumber(p, t.calls[i] ? t.nanoseconds[i] / t.calls[i] : 0, 16);
+        *p++ = '\n';
+    }
+    ::write(fd, buffer, p - buffer);
+}
+
+inline void writeJson(std::ostream& out) {
+    Totals t = totals();
+    out << "{\"threads\": " << t.threads << ", \"counters\": {";
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        out << (i ? ", " : "") << "\"" << NAMES[i] << "\": {\"calls\": " << t.calls[i] << ", \"ns\": " << t.nanoseconds[i] << "}";
+    }
+    out << "}}" << std::endl;
+}
+
+inline void dumpAtExit() {
+    if (const char* path = std::getenv("CHESS_INSTRUMENTATION_JSON")) {
+        std::ofstream out(path);
+        writeJson(out);
+    } else {
+        writeTable(STDERR_FILENO);
+    }
+}
+
+inline bool install() {
+    std::atexit(dumpAtExit);
+    std::signal(SIGUSR1, [](int) { writeTable(STDERR_FILENO); });
+    return true;
+}
+
+inline const bool g_installed = install();
+
+} // instrumentation
+
+} // CHESS
+
+#define CHESS_INSTRUMENT_CONCAT_(a, b) a##b
+#define CHESS_INSTRUMENT_NAME_(line) CHESS_INSTRUMENT_CONCAT_(chessInstrumentScope, line)
+#define CHESS_INSTRUMENT(counter) ::CHESS::instrumentation::Scope CHESS_INSTRUMENT_NAME_(__LINE__)(::CHESS::instrumentation::counter)
+
+#else
+
+#define CHESS_INSTRUMENT(counter)
+
+#endif
+
+#endif
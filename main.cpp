@@ -1,6 +1,177 @@
 #include "game.hpp"
+#include "batchValidator.hpp"
+#include "positionIndex.hpp"
+#include "bitbase.hpp"
+#include "gameServer.hpp"
+#include "mateSolver.hpp"
+#include "perft.hpp"
 
-int main() {
-    CHESS::Game game;
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--validate" && argc > 2) {
+        unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+        return CHESS::validateArchive(argv[2], threads);
+    }
+    if (mode == "--import" && argc > 3) {
+        return CHESS::importArchive(argv[2], argv[3]);
+    }
+    if (mode == "--show" && argc > 3) {
+        return CHESS::showArchivedGame(argv[2], std::stoull(argv[3]));
+    }
+    if (mode == "--build-index" && argc > 3) {
+        CHESS::GameArchive gameArchive(argv[2]);
+        std::cout << "indexed positions: " << CHESS::buildPositionIndex(gameArchive, argv[3]) << std::endl;
+        return 0;
+    }
+    if (mode == "--find" && argc > 2) {
+        return CHESS::findGames(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+    }
+    if (mode == "--build-book" && argc > 3) {
+        std::cout << "book entries: " << CHESS::buildPolyglotBook(argv[2], argv[3]) << std::endl;
+        return 0;
+    }
+    if (mode == "--bitbase" && argc > 3) {
+        CHESS::BitbaseGenerator generator;
+        for (int i = 3; i < argc; ++i) {
+            generator.generate(argv[i]);
+        }
+        generator.write(argv[2]);
+        for (const auto& table : generator.getTables()) {
+            std::cout << table.first << ": " << table.second.size() << " positions" << std::endl;
+        }
+        return 0;
+    }
+    if (mode == "--server" && argc > 2) {
+        unsigned workers = argc > 3 ? std::stoul(argv[3]) : 2;
+        CHESS::GameServer server(argv[2], workers);
+        server.run();
+        return 0;
+    }
+    if (mode == "--mate" && argc > 2) {
+        // the position after the given moves, the side to move attacks
+        CHESS::Chess chess;
+        for (int i = 3; i < argc; ++i) {
+            CHESS::Move move = CHESS::san::parseInput(chess, argv[i]);
+            if (move.isNull() || !chess.makeMove(chess.getSideToMove(), move)) {
+                std::cerr << "Illegal move " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        CHESS::mate::MateSolver solver;
+        CHESS::mate::Result result = solver.solve(chess.getPosition(), std::stoi(argv[2]));
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        if (result.outcome == CHESS::mate::Result::OUTCOME::MATE) {
+            std::cout << "mate in " << result.moves << ":";
+            for (CHESS::Move move : result.line) {
+                std::cout << ' ' << move.source() << move.destination();
+            }
+        } else {
+            std::cout << (result.outcome == CHESS::mate::Result::OUTCOME::NO_MATE ? "no mate in " : "unknown, node limit, mate in ") << argv[2];
+        }
+        std::cout << " (nodes " << result.nodes << ", " << milliseconds << " ms)" << std::endl;
+        return result.outcome == CHESS::mate::Result::OUTCOME::MATE ? 0 : 2;
+    }
+    if (mode == "--perft" && argc > 2) {
+        // --perft DEPTH [THREADS] [verify] ["FEN"] [moves...]: divide, then nodes/s single-threaded and with THREADS threads
+        int depth = std::stoi(argv[2]);
+        int first = 3;
+        unsigned threads = std::thread::hardware_concurrency();
+        if (argc > first && std::isdigit(static_cast<unsigned char>(argv[first][0]))) threads = std::stoul(argv[first++]);
+        bool verify = argc > first && std::string(argv[first]) == "verify";
+        if (verify) ++first;
+        CHESS::Chess chess;
+        if (argc > first && std::string(argv[first]).find('/') != std::string::npos) { // the root is a FEN
+            CHESS::Position root;
+            if (!CHESS::parseFen(argv[first], root)) {
+                std::cerr << "Bad FEN " << argv[first] << std::endl;
+                return 1;
+            }
+            chess.setPosition(root);
+            ++first;
+        }
+        for (int i = first; i < argc; ++i) {
+            CHESS::Move move = CHESS::san::parseInput(chess, argv[i]);
+            if (move.isNull() || !chess.makeMove(chess.getSideToMove(), move)) {
+                std::cerr << "Illegal move " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        double single = 0;
+        for (unsigned t : {1u, threads}) {
+            if (t == 1 && single > 0) break; // THREADS is 1
+            CHESS::perft::Perft perft(t, 1 << 22, verify);
+            CHESS::perft::Result result = perft.run(chess.getPosition(), depth);
+            if (t == 1) {
+                for (const auto& [move, nodes] : result.divide) {
+                    std::cout << move.source() << move.destination() << ": " << nodes << '\n';
+                }
+                single = result.seconds;
+            }
+            std::cout << "nodes " << result.nodes << " time " << result.seconds << " s nps " << static_cast<std::uint64_t>(result.nodesPerSecond())
+                      << " threads " << t;
+            if (t != 1) std::cout << " speedup " << (result.seconds > 0 ? single / result.seconds : 0);
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+    if (mode == "--headless") {
+        // moves from a file ("-f path"), the arguments, or stdin
+        std::ios::sync_with_stdio(false);
+        CHESS::Game game;
+        if (argc > 3 && std::string(argv[2]) == "-f") {
+            std::ifstream in(argv[3]);
+            if (!in) {
+                std::cerr << "Can't open " << argv[3] << std::endl;
+                return 1;
+            }
+            game.playHeadless(in, std::cout);
+        } else if (argc > 2) {
+            std::stringstream in;
+            for (int i = 2; i < argc; ++i) {
+                in << argv[i] << '\n';
+            }
+            game.playHeadless(in, std::cout);
+        } else {
+            game.playHeadless(std::cin, std::cout);
+        }
+        return 0;
+    }
+#ifdef CHESS_ALLOC_TRACKING
+    if (mode == "--alloc-report") {
+        // moves from a file ("-f path"), the arguments, or stdin
+        std::ifstream file;
+        std::stringstream args;
+        if (argc > 3 && std::string(argv[2]) == "-f") {
+            file.open(argv[3]);
+        } else {
+            for (int i = 2; i < argc; ++i) {
+                args << argv[i] << '\n';
+            }
+        }
+        std::istream& in = file.is_open() ? static_cast<std::istream&>(file) : argc > 2 ? static_cast<std::istream&>(args) : std::cin;
+        CHESS::reportAllocationsPerPly(in, std::cout);
+        return 0;
+    }
+#endif
+    std::string archivePath;
+    std::string bookPath;
+    bool highlight = true;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--archive") archivePath = argv[i + 1];
+        if (option == "--book") bookPath = argv[i + 1];
+        if (option == "--highlight") highlight = std::string(argv[i + 1]) != "off";
+    }
+    CHESS::Game game(archivePath);
+    if (!bookPath.empty()) {
+        try {
+            game.setBook(bookPath);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    game.m_renderer.setHighlightLastMove(highlight);
     game.play();
 }
\ No newline at end of file
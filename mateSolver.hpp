@@ -0,0 +1,269 @@
+/**
+ * @file mateSolver.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Mate-in-N solver: depth-first proof-number search (df-pn) for a forced mate by the side to move.
+ *
+ *  Every node has a proof number (how many leaves must still be proven for a mate) and a disproof number,
+ *  kept as phi/delta from the side to move's point of view: phi(n) = min delta(child), delta(n) = sum phi(child).
+ *  The search always expands the most proving child, with thresholds instead of a best-first tree in memory,
+ *  so it goes deep into forcing lines and drops the rest early; this is what makes it much faster than
+ *  alpha-beta for mates. The nodes are kept in a fixed size table (4 entry buckets, the entry with the
+ *  least work is replaced), re-expanded if they were replaced.
+ *
+ *  The key of a node is the position hash with the moves left to the attacker, so a mate-in-N search
+ *  has no cycles. solve tries N = 1, 2, ... up to the limit, the first proven N is the shortest mate,
+ *  then the line is read back: the attacker plays the fastest mate, the defender the longest resistance.
+ *  Legal moves come from a scratch Chess loaded with Chess::setPosition, children are copy-made Positions.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MATESOLVER_H_
+#define MATESOLVER_H_
+
+#include "chess.hpp"
+#include "position.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace CHESS {
+
+namespace mate {
+
+constexpr std::uint32_t INFINITE_NUMBER = 1u << 30;
+constexpr int MAX_MOVES = 16;
+
+struct Result {
+    enum class OUTCOME { MATE, NO_MATE, UNKNOWN }; // UNKNOWN: the node limit was reached
+    OUTCOME outcome = OUTCOME::UNKNOWN;
+    int moves = 0;          // of the attacker, for a mate
+    std::vector<Move> line; // the forced line, ends with the mate
+    std::uint64_t nodes = 0;
+};
+
+class MateSolver {
+public:
+    explicit MateSolver(std::size_t tableEntries = 1 << 20, std::uint64_t nodeLimit = 50000000);
+    MateSolver(const MateSolver&) = delete;
+    MateSolver& operator=(const MateSolver&) = delete;
+    MateSolver(MateSolver&&) = delete;
+    MateSolver& operator=(MateSolver&&) = delete;
+    ~MateSolver() = default;
+
+    // the shortest mate by the side to move in at most maxMoves of its moves
+    Result solve(const Position& root, int maxMoves);
+
+private:
+    struct Entry {
+        std::uint64_t key = 0;
+        std::uint32_t phi = 1;
+        std::uint32_t delta = 1;
+        std::uint32_t work = 0; // nodes spent under it, the replacement priority
+        std::uint16_t move = 0; // the most proving child
+    };
+    static constexpr std::size_t BUCKET = 4;
+
+    // phi/delta of the node with movesLeft after a full search, INFINITE_NUMBER/0 if its side to move loses
+    Entry prove(const Position& position, int movesLeft);
+    void mid(const Position& position, int movesLeft, int ply, std::uint32_t thresholdPhi, std::uint32_t thresholdDelta);
+    int fastestMate(const Position& position, int movesLeft);
+    void readLine(const Position& position, int movesLeft, std::vector<Move>& line);
+
+    bool isAttacker(const Position& position) const {
+        return position.side() == m_attacker;
+    }
+    std::uint64_t key(const Position& position, int movesLeft) const {
+        std::uint64_t salt = (static_cast<std::uint64_t>(movesLeft) << 1 | static_cast<std::uint64_t>(m_attacker)) + 1;
+        return position.hash ^ (salt * 0x9E3779B97F4A7C15ULL);
+    }
+    Entry lookup(std::uint64_t key) const;
+    void store(const Entry& entry);
+    bool generate(const Position& position, std::vector<Move>& moves); // true if the side to move has no moves and is in check
+
+    Chess m_chess;
+    std::vector<Entry> m_table;
+    std::size_t m_buckets;
+    std::uint64_t m_nodes = 0;
+    std::uint64_t m_nodeLimit;
+    chessPiece::COLOR m_attacker = chessPiece::COLOR::WHITE;
+    std::vector<Move> m_moves[2 * MAX_MOVES + 1];
+    std::vector<std::uint64_t> m_keys[2 * MAX_MOVES + 1];
+};
+
+MateSolver::MateSolver(std::size_t tableEntries, std::uint64_t nodeLimit) : m_nodeLimit(nodeLimit) {
+    m_buckets = std::max<std::size_t>(tableEntries / BUCKET, 1);
+    m_table.resize(m_buckets * BUCKET);
+}
+
+Result MateSolver::solve(const Position& root, int maxMoves) {
+    Result result;
+    m_attacker = root.side();
+    m_nodes = 0;
+    maxMoves = std::clamp(maxMoves, 1, MAX_MOVES);
+    result.outcome = Result::OUTCOME::NO_MATE;
+    for (int n = 1; n <= maxMoves; ++n) {
+        Entry entry = prove(root, n);
+        if (m_nodes >= m_nodeLimit) {
+            result.outcome = Result::OUTCOME::UNKNOWN;
+            break;
+        }
+        if (entry.phi == 0) {
+            result.outcome = Result::OUTCOME::MATE;
+            result.moves = n;
+            readLine(root, n, result.line);
+            break;
+        }
+    }
+    result.nodes = m_nodes;
+    return result;
+}
+
+MateSolver::Entry MateSolver::prove(const Position& position, int movesLeft) {
+    const std::uint64_t nodeKey = key(position, movesLeft);
+    Entry entry = lookup(nodeKey);
+    if (entry.phi != 0 && entry.delta != 0) mid(position, movesLeft, 0, INFINITE_NUMBER, INFINITE_NUMBER);
+    return lookup(nodeKey);
+}
+
+void MateSolver::mid(const Position& position, int movesLeft, int ply, std::uint32_t thresholdPhi, std::uint32_t thresholdDelta) {
+    const std::uint64_t start = ++m_nodes;
+    Entry node;
+    node.key = key(position, movesLeft);
+
+    auto& moves = m_moves[ply];
+    bool inCheck = generate(position, moves);
+    const bool attacker = isAttacker(position);
+    bool lost = moves.empty() && (inCheck || attacker);          // mated, or the attacker stalemated
+    bool held = (moves.empty() && !lost) || (!attacker && movesLeft == 0); // the defender survives the attack
+    if (lost || held) {
+        node.phi = lost ? INFINITE_NUMBER : 0;
+        node.delta = lost ? 0 : INFINITE_NUMBER;
+        node.work = 1;
+        store(node);
+        return;
+    }
+
+    const int childMovesLeft = attacker ? movesLeft - 1 : movesLeft;
+    auto& keys = m_keys[ply];
+    keys.clear();
+    for (Move move : moves) {
+        Position child = position;
+        child.makeMove(move);
+        keys.push_back(key(child, childMovesLeft));
+    }
+
+    while (true) {
+        // phi = min delta(child), delta = sum phi(child)
+        std::uint32_t phi = INFINITE_NUMBER, secondDelta = INFINITE_NUMBER;
+        std::uint64_t delta = 0;
+        std::size_t best = 0;
+        std::uint32_t bestPhi = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            Entry child = lookup(keys[i]);
+            delta += child.phi;
+            if (child.delta < phi) {
+                secondDelta = phi;
+                phi = child.delta;
+                best = i;
+                bestPhi = child.phi;
+            } else if (child.delta < secondDelta) {
+                secondDelta = child.delta;
+            }
+        }
+        node.phi = phi;
+        node.delta = static_cast<std::uint32_t>(std::min<std::uint64_t>(delta, INFINITE_NUMBER));
+        node.move = moves[best].raw();
+        if (node.phi >= thresholdPhi || node.delta >= thresholdDelta || m_nodes >= m_nodeLimit) break;
+
+        // the child keeps below both thresholds of the node: delta stays under thresholdDelta and phi under the runner-up
+        std::uint64_t childPhi = static_cast<std::uint64_t>(thresholdDelta) - node.delta + bestPhi;
+        std::uint32_t childThresholdPhi = static_cast<std::uint32_t>(std::min<std::uint64_t>(childPhi, INFINITE_NUMBER));
+        std::uint32_t childThresholdDelta = std::min(thresholdPhi, secondDelta == INFINITE_NUMBER ? INFINITE_NUMBER : secondDelta + 1);
+        Position child = position;
+        child.makeMove(moves[best]);
+        mid(child, childMovesLeft, ply + 1, childThresholdPhi, childThresholdDelta);
+    }
+    node.work = static_cast<std::uint32_t>(std::min<std::uint64_t>(m_nodes - start + 1, UINT32_MAX));
+    store(node);
+}
+
+// the fewest attacker moves (at most movesLeft) of a forced mate from an attacker node, 0 if none
+int MateSolver::fastestMate(const Position& position, int movesLeft) {
+    for (int n = 1; n <= movesLeft; ++n) {
+        if (prove(position, n).phi == 0) return n;
+    }
+    return 0;
+}
+
+void MateSolver::readLine(const Position& position, int movesLeft, std::vector<Move>& line) {
+    std::vector<Move> moves;
+    generate(position, moves);
+    if (moves.empty() || m_nodes >= m_nodeLimit) return;
+    Move chosen;
+    int chosenMoves = 0;
+    for (Move move : moves) {
+        Position child = position;
+        child.makeMove(move);
+        if (isAttacker(position)) {
+            // a defender node mated within movesLeft - 1 (its side to move loses)
+            if (prove(child, movesLeft - 1).phi == INFINITE_NUMBER) {
+                chosen = move;
+                break;
+            }
+        } else {
+            int n = fastestMate(child, movesLeft);
+            if (n > chosenMoves) {
+                chosen = move;
+                chosenMoves = n;
+            }
+        }
+    }
+    if (chosen.isNull()) return;
+    line.push_back(chosen);
+    Position child = position;
+    child.makeMove(chosen);
+    readLine(child, isAttacker(position) ? movesLeft - 1 : chosenMoves, line);
+}
+
+// unknown nodes start at 1/1
+MateSolver::Entry MateSolver::lookup(std::uint64_t key) const {
+    const Entry* p_bucket = &m_table[(key % m_buckets) * BUCKET];
+    for (std::size_t i = 0; i < BUCKET; ++i) {
+        if (p_bucket[i].key == key) return p_bucket[i];
+    }
+    Entry entry;
+    entry.key = key;
+    return entry;
+}
+
+void MateSolver::store(const Entry& entry) {
+    Entry* p_bucket = &m_table[(entry.key % m_buckets) * BUCKET];
+    Entry* p_victim = p_bucket;
+    for (std::size_t i = 0; i < BUCKET; ++i) {
+        if (p_bucket[i].key == entry.key) {
+            p_victim = p_bucket + i;
+            break;
+        }
+        if (p_bucket[i].work < p_victim->work) p_victim = p_bucket + i;
+    }
+    *p_victim = entry;
+}
+
+bool MateSolver::generate(const Position& position, std::vector<Move>& moves) {
+    m_chess.setPosition(position);
+    m_chess.getLegalMoves(moves);
+    if (!moves.empty()) return false; // only asked for mates and stalemates
+    return position.side() == chessPiece::COLOR::WHITE ? m_chess.isWhiteKingUnderAttack() : m_chess.isBlackKingUnderAttack();
+}
+
+} // mate
+
+} // CHESS
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file material.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Material key: the piece counts of both sides packed in one integer, 4 bits per (color, kind).
+ *  Kings are not counted, there is always one of each. Bishops are counted by the color of their square
+ *  (a bishop never changes it), so the key also tells if all the bishops are on squares of one color.
+ *
+ *  Chess keeps the key of its position up to date in move() and performPromotion(): a capture
+ *  subtracts the unit of the captured piece, a promotion swaps the pawn for the queen.
+ *  The draw rules which only depend on the material are then O(1) tests on the key, and the key is
+ *  the index of the endgame handlers (endgame.hpp).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MATERIAL_H_
+#define MATERIAL_H_
+
+#include "chessPiece.hpp"
+#include "position.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace CHESS {
+
+namespace material {
+
+enum KIND { QUEEN, ROOK, LIGHT_BISHOP, DARK_BISHOP, KNIGHT, PAWN, KINDS };
+
+constexpr int BITS = 4;
+
+constexpr int kindOf(chessPiece::PIECE piece, int square) {
+    switch (piece) {
+        case chessPiece::PIECE::QUEEN: return QUEEN;
+        case chessPiece::PIECE::ROOK: return ROOK;
+        case chessPiece::PIECE::BISHOP: return (square % 8 + square / 8) % 2 ? LIGHT_BISHOP : DARK_BISHOP; // a1 is dark
+        case chessPiece::PIECE::KNIGHT: return KNIGHT;
+        case chessPiece::PIECE::PAWN: return PAWN;
+        default: return KINDS;
+    }
+}
+
+constexpr std::uint64_t unit(chessPiece::COLOR color, int kind) {
+    return kind == KINDS ? 0 : std::uint64_t(1) << ((static_cast<int>(color) * KINDS + kind) * BITS);
+}
+
+// what a piece adds to the key, 0 for a king
+constexpr std::uint64_t unit(chessPiece::COLOR color, chessPiece::PIECE piece, int square) {
+    return unit(color, kindOf(piece, square));
+}
+
+constexpr int count(std::uint64_t key, chessPiece::COLOR color, int kind) {
+    return static_cast<int>((key >> ((static_cast<int>(color) * KINDS + kind) * BITS)) & ((1 << BITS) - 1));
+}
+
+// the units of a kind for both colors, times 15: masks the counts of the kind
+constexpr std::uint64_t mask(int kind) {
+    return (unit(chessPiece::COLOR::WHITE, kind) | unit(chessPiece::COLOR::BLACK, kind)) * ((1 << BITS) - 1);
+}
+
+constexpr std::uint64_t LIGHT_SQUARES = 0x55AA55AA55AA55AAULL;
+
+// the key of a position from scratch, a popcount per (color, kind)
+inline std::uint64_t keyOf(const Position& position) {
+    using PIECE = chessPiece::PIECE;
+    std::uint64_t key = 0;
+    for (chessPiece::COLOR color : {chessPiece::COLOR::WHITE, chessPiece::COLOR::BLACK}) {
+        const std::uint64_t bishops = position.bitboard(color, PIECE::BISHOP);
+        key += unit(color, QUEEN) * std::popcount(position.bitboard(color, PIECE::QUEEN));
+        key += unit(color, ROOK) * std::popcount(position.bitboard(color, PIECE::ROOK));
+        key += unit(color, LIGHT_BISHOP) * std::popcount(bishops & LIGHT_SQUARES);
+        key += unit(color, DARK_BISHOP) * std::popcount(bishops & ~LIGHT_SQUARES);
+        key += unit(color, KNIGHT) * std::popcount(position.bitboard(color, PIECE::KNIGHT));
+        key += unit(color, PAWN) * std::popcount(position.bitboard(color, PIECE::PAWN));
+    }
+    return key;
+}
+
+// "KBNK" (as the bitbase signatures: "K", the white pieces, "K", the black pieces): the keys of the material,
+// one per split of the bishops between the square colors. Empty if the signature is malformed.
+inline std::vector<std::uint64_t> keysOf(std::string_view signature) {
+    std::vector<std::uint64_t> keys{0};
+    int kings = 0;
+    for (char c : signature) {
+        if (c == 'K') {
+            if (++kings > 2) return {};
+            continue;
+        }
+        const int kind = c == 'Q' ? QUEEN : c == 'R' ? ROOK : c == 'N' ? KNIGHT : c == 'P' ? PAWN : c == 'B' ? LIGHT_BISHOP : KINDS;
+        if (kind == KINDS || kings == 0) return {};
+        const chessPiece::COLOR color = kings == 1 ? chessPiece::COLOR::WHITE : chessPiece::COLOR::BLACK;
+        std::vector<std::uint64_t> next;
+        for (std::uint64_t key : keys) {
+            next.push_back(key + unit(color, kind));
+            if (kind == LIGHT_BISHOP) next.push_back(key + unit(color, DARK_BISHOP));
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        keys = std::move(next);
+    }
+    if (kings != 2) return {};
+    return keys;
+}
+
+// the same material with the colors swapped
+constexpr std::uint64_t mirrored(std::uint64_t key) {
+    constexpr int SIDE = KINDS * BITS;
+    return (key >> SIDE) | ((key & ((std::uint64_t(1) << SIDE) - 1)) << SIDE);
+}
+
+// No mate is possible by any sequence of moves: no pawns, rooks or queens and either a single knight
+// or only bishops, all on squares of one color (K v K, KN v K, KB v K, KB v KB with same colored bishops).
+constexpr bool isInsufficient(std::uint64_t key) {
+    if (key & (mask(QUEEN) | mask(ROOK) | mask(PAWN))) return false;
+    const std::uint64_t knights = key & mask(KNIGHT);
+    if (!knights) return !(key & mask(LIGHT_BISHOP)) || !(key & mask(DARK_BISHOP));
+    return key == unit(chessPiece::COLOR::WHITE, KNIGHT) || key == unit(chessPiece::COLOR::BLACK, KNIGHT);
+}
+
+} // material
+
+} // CHESS
+
+#endif
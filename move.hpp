@@ -0,0 +1,77 @@
+/**
+ * @file move.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Compact 16 bit move representation used for the move history.
+ *  Bits 0-5: destination square, bits 6-11: source square,
+ *  bits 12-13: promotion piece (knight, bishop, rook, queen), bits 14-15: move type.
+ *  Squares are indexed a1 = 0, b1 = 1 ... h8 = 63.
+ *  Move is trivially copyable, so a history can be copied to a storage with memcpy (2 bytes per ply).
+ *  Move() (a1a1) is the null move, returned when there is no move.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MOVE_H_
+#define MOVE_H_
+
+#include "chessPiece.hpp"
+#include <cstdint>
+#include <type_traits>
+
+namespace CHESS {
+
+class Move {
+public:
+    enum class TYPE : std::uint16_t { NORMAL = 0, PROMOTION = 1, EN_PASSANT = 2, CASTLING = 3 };
+
+    constexpr Move() = default;
+    constexpr Move(int from, int to, TYPE type = TYPE::NORMAL, chessPiece::PIECE promotion = chessPiece::PIECE::QUEEN) :
+            m_data(static_cast<std::uint16_t>(to | (from << 6) | (promotionBits(promotion) << 12) |
+                                              (static_cast<std::uint16_t>(type) << 14))) {
+    }
+    Move(const std::string& source, const std::string& destination, TYPE type = TYPE::NORMAL) :
+            Move(squareIndex(source), squareIndex(destination), type) {
+    }
+
+    constexpr int from() const { return (m_data >> 6) & 0x3F; }
+    constexpr int to() const { return m_data & 0x3F; }
+    constexpr TYPE type() const { return static_cast<TYPE>(m_data >> 14); }
+    constexpr chessPiece::PIECE promotion() const {
+        constexpr chessPiece::PIECE pieces[] = { chessPiece::PIECE::KNIGHT, chessPiece::PIECE::BISHOP,
+                                                 chessPiece::PIECE::ROOK, chessPiece::PIECE::QUEEN };
+        return pieces[(m_data >> 12) & 0x3];
+    }
+    constexpr bool isNull() const { return m_data == 0; }
+    constexpr std::uint16_t raw() const { return m_data; }
+    static constexpr Move fromRaw(std::uint16_t data) { Move m; m.m_data = data; return m; }
+
+    std::string source() const { return squareName(from()); }
+    std::string destination() const { return squareName(to()); }
+
+    constexpr bool operator==(const Move& other) const { return m_data == other.m_data; }
+    constexpr bool operator!=(const Move& other) const { return m_data != other.m_data; }
+
+private:
+    static constexpr std::uint16_t promotionBits(chessPiece::PIECE piece) {
+        switch (piece) {
+            case chessPiece::PIECE::KNIGHT: return 0;
+            case chessPiece::PIECE::BISHOP: return 1;
+            case chessPiece::PIECE::ROOK: return 2;
+            default: return 3;
+        }
+    }
+
+    std::uint16_t m_data = 0;
+};
+
+static_assert(sizeof(Move) == 2, "Move must stay 16 bit");
+static_assert(std::is_trivially_copyable_v<Move>, "Move histories are copied with memcpy");
+
+} // CHESS
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * @file perft.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Perft: the number of legal move sequences of a given depth, the standard check of a move generator
+ *  against published counts.
+ *
+ *  The legal moves of every node come from Chess (Chess::setPosition, Chess::getLegalMoves), so a perft
+ *  run goes through the validation of every piece, castling, en passant, promotion and the check rules.
+ *  Children are copy-made with Position::makeMove; with verify every child is also played by
+ *  Chess::makeMove and both positions must be equal, which cross-checks the two move implementations.
+ *
+ *  - bulk counting: the last ply is not played, a node at depth 1 counts its legal moves
+ *  - a table of subtree counts keyed by (position hash, depth) shared by the threads, lockless:
+ *    a slot keeps the count and key ^ count, a torn slot doesn't match any key and is a miss
+ *  - the root moves are split between the threads, every thread has its own Chess
+ *
+ *  The game always promotes to a queen, so the counts of positions with promotions in the tree are lower
+ *  than the published ones (which count the 4 promotions), the others must match exactly.
+ *  The root can be any position given in FEN (parseFen, position.hpp), e.g. the published test positions.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef PERFT_H_
+#define PERFT_H_
+
+#include "chess.hpp"
+#include "position.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CHESS {
+
+namespace perft {
+
+constexpr int MAX_DEPTH = 32;
+
+struct Result {
+    std::uint64_t nodes = 0;
+    std::vector<std::pair<Move, std::uint64_t>> divide; // nodes under every root move
+    double seconds = 0;
+    unsigned threads = 1;
+
+    double nodesPerSecond() const {
+        return seconds > 0 ? nodes / seconds : 0;
+    }
+};
+
+class Table {
+public:
+    explicit Table(std::size_t entries); // rounded down to a power of 2, 0 disables the table
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+    Table(Table&&) = delete;
+    Table& operator=(Table&&) = delete;
+    ~Table() = default;
+
+    bool probe(std::uint64_t hash, int depth, std::uint64_t& count) const;
+    void store(std::uint64_t hash, int depth, std::uint64_t count);
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{0}; // key ^ count
+        std::atomic<std::uint64_t> count{0};
+    };
+    static std::uint64_t key(std::uint64_t hash, int depth) {
+        return hash ^ (static_cast<std::uint64_t>(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    std::vector<Slot> m_slots;
+    std::uint64_t m_mask = 0;
+};
+
+Table::Table(std::size_t entries) {
+    if (!entries) return;
+    std::size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    m_slots = std::vector<Slot>(size);
+    m_mask = size - 1;
+}
+
+bool Table::probe(std::uint64_t hash, int depth, std::uint64_t& count) const {
+    if (m_slots.empty()) return false;
+    const std::uint64_t k = key(hash, depth);
+    const Slot& slot = m_slots[k & m_mask];
+    std::uint64_t value = slot.count.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ value) != k) return false;
+    count = value;
+    return true;
+}
+
+void Table::store(std::uint64_t hash, int depth, std::uint64_t count) {
+    if (m_slots.empty()) return;
+    const std::uint64_t k = key(hash, depth);
+    Slot& slot = m_slots[k & m_mask];
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.check.store(k ^ count, std::memory_order_relaxed);
+}
+
+class Perft {
+public:
+    explicit Perft(unsigned threads = std::thread::hardware_concurrency(), std::size_t tableEntries = 1 << 22, bool verify = false) :
+            m_threads(threads ? threads : 1), m_tableEntries(tableEntries), m_verify(verify) {}
+    Perft(const Perft&) = delete;
+    Perft& operator=(const Perft&) = delete;
+    Perft(Perft&&) = delete;
+    Perft& operator=(Perft&&) = delete;
+    ~Perft() = default;
+
+    // a fresh table for every run, so runs with different thread counts can be compared
+    Result run(const Position& root, int depth);
+
+private:
+    struct Worker {
+        Chess chess;
+        std::vector<Move> moves[MAX_DEPTH];
+    };
+
+    std::uint64_t count(Worker& worker, Table& table, const Position& position, int depth);
+
+    unsigned m_threads;
+    std::size_t m_tableEntries;
+    bool m_verify;
+};
+
+Result Perft::run(const Position& root, int depth) {
+    const auto start = std::chrono::steady_clock::now();
+    depth = std::clamp(depth, 1, MAX_DEPTH);
+    Result result;
+    result.threads = m_threads;
+    Table table(m_tableEntries);
+    std::vector<Move> rootMoves;
+    {
+        Chess chess;
+        chess.setPosition(root);
+        chess.getLegalMoves(rootMoves);
+    }
+    result.divide.resize(rootMoves.size());
+
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::exception_ptr error; // the first verification failure, rethrown here
+    auto work = [&]() {
+        try {
+            auto p_worker = std::make_unique<Worker>();
+            while (true) {
+                std::size_t i = next.fetch_add(1);
+                if (i >= rootMoves.size()) break;
+                Position child = root;
+                child.makeMove(rootMoves[i]);
+                result.divide[i] = {rootMoves[i], depth == 1 ? 1 : count(*p_worker, table, child, depth - 1)};
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+            next = rootMoves.size();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < m_threads; ++t) pool.emplace_back(work);
+    for (auto& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+
+    for (const auto& entry : result.divide) {
+        result.nodes += entry.second;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::uint64_t Perft::count(Worker& worker, Table& table, const Position& position, int depth) {
+    std::uint64_t nodes = 0;
+    if (table.probe(position.hash, depth, nodes)) return nodes;
+    auto& moves = worker.moves[depth];
+    worker.chess.setPosition(position);
+    worker.chess.getLegalMoves(moves);
+    if (depth == 1 && !m_verify) {
+        nodes = moves.size();
+    } else {
+        for (Move move : moves) {
+            Position child = position;
+            child.makeMove(move);
+            if (m_verify) {
+                worker.chess.setPosition(position);
+                worker.chess.makeMove(position.side(), move);
+                if (!(worker.chess.getPosition() == child)) {
+                    throw std::logic_error("Position::makeMove and Chess::makeMove differ on " + move.source() + move.destination());
+                }
+            }
+            nodes += depth == 1 ? 1 : count(worker, table, child, depth - 1);
+        }
+    }
+    table.store(position.hash, depth, nodes);
+    return nodes;
+}
+
+} // perft
+
+} // CHESS
+
+#endif
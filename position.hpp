@@ -0,0 +1,250 @@
+/**
+ * @file position.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Position: a compact, trivially copyable snapshot of a Chess position (80 bytes).
+ *  Chess owns its board and pieces through raw pointers and cannot be copied, a Position can:
+ *  it is exported by Chess::getPosition, copied by memcpy to other threads or into tables,
+ *  and turned back into a playable game by Chess::setPosition.
+ *
+ *  Squares are squareIndex values (a1 = 0), bit i of a bitboard is square i.
+ *  pieces[] is indexed by chessPiece::PIECE, colors[] by chessPiece::COLOR.
+ *
+ *  makeMove plays a legal move (as generated by Chess::getLegalMoves) on the snapshot itself and keeps
+ *  the hash, castling rights, en passant file and clocks exactly as Chess would report them,
+ *  so searches can copy-make positions without rebuilding a Chess for every child.
+ *  parseFen reads a position from Forsyth-Edwards Notation, with the full hash (computeHash).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include "chessPiece.hpp"
+#include "move.hpp"
+#include "squareList.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace CHESS {
+
+struct Position {
+    std::uint64_t colors[2];     // occupancy of each side
+    std::uint64_t pieces[6];     // both sides, by piece type
+    std::uint64_t hash;          // Chess::getHash of the position, 0 if not known
+    std::uint16_t fullmoveNumber;
+    std::uint8_t halfmoveClock;  // plies since the last capture or pawn move
+    std::uint8_t sideToMove;     // chessPiece::COLOR
+    std::uint8_t castlingRights; // zobrist::CASTLING bits
+    std::int8_t enPassantFile;   // -1 if there is no en passant capture
+    std::uint8_t reserved[2];
+
+    std::uint64_t occupancy() const {
+        return colors[0] | colors[1];
+    }
+    std::uint64_t bitboard(chessPiece::COLOR color, chessPiece::PIECE piece) const {
+        return colors[static_cast<int>(color)] & pieces[static_cast<int>(piece)];
+    }
+    chessPiece::COLOR side() const {
+        return static_cast<chessPiece::COLOR>(sideToMove);
+    }
+
+    // PIECE::NONE for an empty square
+    chessPiece::PIECE pieceAt(int square) const {
+        for (int piece = 0; piece < 6; ++piece) {
+            if (pieces[piece] & squareBit(square)) return static_cast<chessPiece::PIECE>(piece);
+        }
+        return chessPiece::PIECE::NONE;
+    }
+    chessPiece::COLOR colorAt(int square) const {
+        return (colors[1] & squareBit(square)) ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE;
+    }
+
+    void place(chessPiece::COLOR color, chessPiece::PIECE piece, int square) {
+        colors[static_cast<int>(color)] |= squareBit(square);
+        pieces[static_cast<int>(piece)] |= squareBit(square);
+    }
+
+    void makeMove(Move move);
+    std::uint64_t computeHash() const;
+
+    bool operator==(const Position&) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<Position> && std::is_standard_layout_v<Position>, "Position is copied by memcpy");
+static_assert(sizeof(Position) == 80, "Position layout");
+
+// the move must be legal, nothing is validated here
+inline void Position::makeMove(Move move) {
+    using PIECE = chessPiece::PIECE;
+    const auto& keys = zobrist::KEYS;
+    const int us = sideToMove, them = 1 - us;
+    const int from = move.from(), to = move.to();
+    const int piece = static_cast<int>(pieceAt(from));
+
+    auto toggle = [this, &keys](int color, int type, int square) {
+        colors[color] ^= squareBit(square);
+        pieces[type] ^= squareBit(square);
+        hash ^= keys.piece[color][type][square];
+    };
+
+    if (enPassantFile >= 0) hash ^= keys.enPassant[enPassantFile];
+    for (int i = 0; i < 4; ++i) {
+        if (castlingRights & (1 << i)) hash ^= keys.castling[i];
+    }
+
+    bool capture = colors[them] & squareBit(to);
+    if (capture) toggle(them, static_cast<int>(pieceAt(to)), to);
+    toggle(us, piece, from);
+    toggle(us, piece, to);
+
+    switch (move.type()) {
+        case Move::TYPE::EN_PASSANT:
+            toggle(them, static_cast<int>(PIECE::PAWN), us == 0 ? to - 8 : to + 8);
+            capture = true;
+            break;
+        case Move::TYPE::CASTLING: {
+            bool kingSide = to % 8 == 6;
+            int rank = to - to % 8;
+            toggle(us, static_cast<int>(PIECE::ROOK), rank + (kingSide ? 7 : 0));
+            toggle(us, static_cast<int>(PIECE::ROOK), rank + (kingSide ? 5 : 3));
+            break;
+        }
+        case Move::TYPE::PROMOTION:
+            toggle(us, piece, to);
+            toggle(us, static_cast<int>(move.promotion()), to);
+            break;
+        default:
+            break;
+    }
+
+    // a king or rook leaving its square, or a rook captured on it, loses the castling
+    for (int square : {from, to}) {
+        switch (square) {
+            case 4: castlingRights &= ~(zobrist::WHITE_KING_SIDE | zobrist::WHITE_QUEEN_SIDE); break;
+            case 7: castlingRights &= ~zobrist::WHITE_KING_SIDE; break;
+            case 0: castlingRights &= ~zobrist::WHITE_QUEEN_SIDE; break;
+            case 60: castlingRights &= ~(zobrist::BLACK_KING_SIDE | zobrist::BLACK_QUEEN_SIDE); break;
+            case 63: castlingRights &= ~zobrist::BLACK_KING_SIDE; break;
+            case 56: castlingRights &= ~zobrist::BLACK_QUEEN_SIDE; break;
+            default: break;
+        }
+    }
+
+    // as Chess::getEnPassantFile: a double push next to an opponent pawn
+    enPassantFile = -1;
+    if (piece == static_cast<int>(PIECE::PAWN) && (to - from == 16 || from - to == 16)) {
+        std::uint64_t neighbours = ((squareBit(to) << 1) & 0xfefefefefefefefeULL) | ((squareBit(to) >> 1) & 0x7f7f7f7f7f7f7f7fULL);
+        if (neighbours & colors[them] & pieces[static_cast<int>(PIECE::PAWN)]) enPassantFile = static_cast<std::int8_t>(to % 8);
+    }
+
+    if (enPassantFile >= 0) hash ^= keys.enPassant[enPassantFile];
+    for (int i = 0; i < 4; ++i) {
+        if (castlingRights & (1 << i)) hash ^= keys.castling[i];
+    }
+    hash ^= keys.blackToMove;
+
+    halfmoveClock = (capture || piece == static_cast<int>(PIECE::PAWN)) ? 0 : static_cast<std::uint8_t>(std::min(halfmoveClock + 1, 255));
+    if (us == 1) ++fullmoveNumber;
+    sideToMove = static_cast<std::uint8_t>(them);
+}
+
+// the hash from scratch, the same as Chess::getHash of the position
+inline std::uint64_t Position::computeHash() const {
+    const auto& keys = zobrist::KEYS;
+    std::uint64_t key = 0;
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 6; ++type) {
+            for (std::uint64_t bits = colors[color] & pieces[type]; bits; bits &= bits - 1) {
+                key ^= keys.piece[color][type][std::countr_zero(bits)];
+            }
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (castlingRights & (1 << i)) key ^= keys.castling[i];
+    }
+    if (enPassantFile >= 0) key ^= keys.enPassant[enPassantFile];
+    if (side() == chessPiece::COLOR::BLACK) key ^= keys.blackToMove;
+    return key;
+}
+
+// "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", the clocks may be left out.
+// false if the text is not a FEN. The en passant square is kept only if a pawn can capture, as Chess reports it.
+inline bool parseFen(const std::string& fen, Position& position) {
+    using PIECE = chessPiece::PIECE;
+    std::istringstream in(fen);
+    std::string board, side, castling = "-", enPassant = "-";
+    int halfmoveClock = 0, fullmoveNumber = 1;
+    if (!(in >> board >> side)) return false;
+    in >> castling >> enPassant >> halfmoveClock >> fullmoveNumber;
+    position = Position{};
+    position.enPassantFile = -1;
+    int rank = 7, file = 0;
+    for (char c : board) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            --rank;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else {
+            const char* letters = "kqnbrp"; // chessPiece::PIECE order
+            const char* letter = std::char_traits<char>::find(letters, 6, static_cast<char>(std::tolower(c)));
+            if (!letter || file > 7) return false;
+            position.place(std::isupper(c) ? chessPiece::COLOR::WHITE : chessPiece::COLOR::BLACK, static_cast<PIECE>(letter - letters), rank * 8 + file);
+            ++file;
+        }
+        if (file > 8) return false;
+    }
+    if (rank != 0 || file != 8) return false;
+    if (side != "w" && side != "b") return false;
+    position.sideToMove = static_cast<std::uint8_t>(side == "w" ? chessPiece::COLOR::WHITE : chessPiece::COLOR::BLACK);
+    for (char c : castling) {
+        switch (c) {
+            case 'K': position.castlingRights |= zobrist::WHITE_KING_SIDE; break;
+            case 'Q': position.castlingRights |= zobrist::WHITE_QUEEN_SIDE; break;
+            case 'k': position.castlingRights |= zobrist::BLACK_KING_SIDE; break;
+            case 'q': position.castlingRights |= zobrist::BLACK_QUEEN_SIDE; break;
+            case '-': break;
+            default: return false;
+        }
+    }
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || (enPassant[1] != '3' && enPassant[1] != '6')) return false;
+        const int file = enPassant[0] - 'a';
+        const int pawnRank = position.side() == chessPiece::COLOR::WHITE ? 4 : 3; // of the pawns which can capture
+        const std::uint64_t capturers = position.bitboard(position.side(), PIECE::PAWN) & (std::uint64_t(0xFF) << (8 * pawnRank));
+        const bool pushed = position.bitboard(position.side() == chessPiece::COLOR::WHITE ? chessPiece::COLOR::BLACK : chessPiece::COLOR::WHITE, PIECE::PAWN) & squareBit(pawnRank * 8 + file);
+        if (pushed && capturers & ((file > 0 ? squareBit(pawnRank * 8 + file - 1) : 0) | (file < 7 ? squareBit(pawnRank * 8 + file + 1) : 0))) {
+            position.enPassantFile = static_cast<std::int8_t>(file);
+        }
+    }
+    position.halfmoveClock = static_cast<std::uint8_t>(std::clamp(halfmoveClock, 0, 255));
+    position.fullmoveNumber = static_cast<std::uint16_t>(std::clamp(fullmoveNumber, 1, 65535));
+    // as Chess::getCastlingRights: a right needs the king and the rook on their squares
+    auto home = [&position](chessPiece::COLOR color, PIECE piece, int square) {
+        return (position.bitboard(color, piece) & squareBit(square)) != 0;
+    };
+    const bool whiteKing = home(chessPiece::COLOR::WHITE, PIECE::KING, 4), blackKing = home(chessPiece::COLOR::BLACK, PIECE::KING, 60);
+    if (!whiteKing || !home(chessPiece::COLOR::WHITE, PIECE::ROOK, 7)) position.castlingRights &= ~zobrist::WHITE_KING_SIDE;
+    if (!whiteKing || !home(chessPiece::COLOR::WHITE, PIECE::ROOK, 0)) position.castlingRights &= ~zobrist::WHITE_QUEEN_SIDE;
+    if (!blackKing || !home(chessPiece::COLOR::BLACK, PIECE::ROOK, 63)) position.castlingRights &= ~zobrist::BLACK_KING_SIDE;
+    if (!blackKing || !home(chessPiece::COLOR::BLACK, PIECE::ROOK, 56)) position.castlingRights &= ~zobrist::BLACK_QUEEN_SIDE;
+    position.hash = position.computeHash();
+    return true;
+}
+
+} // CHESS
+
+#endif
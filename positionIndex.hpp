@@ -0,0 +1,269 @@
+/**
+ * @file positionIndex.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  On-disk index from a position hash (Chess::getHash) to the (game id, ply) pairs of the game archive
+ *  where that position was reached. Ply 0 is the initial position.
+ *
+ *  Layout (native byte order): header, optional Bloom filter bits, entries sorted by hash.
+ *  buildPositionIndex replays the archived games through Chess on several threads,
+ *  every thread sorts its own entries and the sorted runs are merged straight to the file.
+ *  PositionIndex maps the file, rejects misses with the Bloom filter and
+ *  finds the hits by binary search, so a query touches a few pages only.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef POSITIONINDEX_H_
+#define POSITIONINDEX_H_
+
+#include "chess.hpp"
+#include "gameArchive.hpp"
+#include "san.hpp"
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <queue>
+#include <fstream>
+
+namespace CHESS {
+
+namespace positionIndex {
+
+constexpr char MAGIC[8] = {'C', 'H', 'S', 'P', 'I', 'D', 'X', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t BLOOM_HASHES = 7;
+constexpr std::uint32_t MAX_BLOOM_HASHES = 64; // a file with more is not trusted
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t bloomHashes;
+    std::uint64_t entryCount;
+    std::uint64_t bloomBits; // 0 if there is no Bloom filter, otherwise a power of 2
+    std::uint64_t reserved[4];
+};
+
+struct Entry {
+    std::uint64_t hash;
+    std::uint32_t gameId;
+    std::uint16_t ply;
+    std::uint16_t reserved;
+
+    bool operator<(const Entry& other) const {
+        return hash < other.hash || (hash == other.hash && (gameId < other.gameId || (gameId == other.gameId && ply < other.ply)));
+    }
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(Entry) == 16, "On-disk layout");
+
+// the i-th Bloom filter bit of the hash, double hashing of the two halves of the (already random) zobrist key
+inline std::uint64_t bloomBit(std::uint64_t hash, std::uint32_t i, std::uint64_t bloomBits) {
+    std::uint64_t h1 = hash;
+    std::uint64_t h2 = (hash >> 32) | (hash << 32) | 1;
+    return (h1 + i * h2) & (bloomBits - 1);
+}
+
+} // positionIndex
+
+struct PositionHit {
+    std::uint32_t gameId;
+    std::uint16_t ply;
+};
+
+// the index is written to outPath, bloomBitsPerEntry = 0 disables the Bloom filter, returns the number of entries
+std::uint64_t buildPositionIndex(const GameArchive& gameArchive, const std::string& outPath,
+                                 unsigned threads = std::thread::hardware_concurrency(), unsigned bloomBitsPerEntry = 10) {
+    using positionIndex::Entry;
+    if (!threads) threads = 1;
+    constexpr std::uint64_t CHUNK = 256; // games taken by a thread at once
+    std::atomic<std::uint64_t> nextGame{0};
+    std::vector<std::vector<Entry>> runs(threads);
+
+    auto worker = [&](std::vector<Entry>& run) {
+        while (true) {
+            std::uint64_t first = nextGame.fetch_add(CHUNK);
+            if (first >= gameArchive.size()) break;
+            std::uint64_t last = std::min<std::uint64_t>(first + CHUNK, gameArchive.size());
+            for (std::uint64_t id = first; id < last; ++id) {
+                Chess chess;
+                std::uint16_t ply = 0;
+                run.push_back({chess.getHash(), static_cast<std::uint32_t>(id), ply, 0});
+                for (Move move : gameArchive[id]) {
+                    if (!chess.makeMove(chess.getSideToMove(), move)) break; // archives hold legal games only
+                    run.push_back({chess.getHash(), static_cast<std::uint32_t>(id), ++ply, 0});
+                }
+            }
+        }
+        std::sort(run.begin(), run.end());
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; ++i) {
+        pool.emplace_back(worker, std::ref(runs[i]));
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    positionIndex::Header header{};
+    std::memcpy(header.magic, positionIndex::MAGIC, sizeof(positionIndex::MAGIC));
+    header.version = positionIndex::VERSION;
+    header.bloomHashes = positionIndex::BLOOM_HASHES;
+    for (const auto& run : runs) {
+        header.entryCount += run.size();
+    }
+    std::vector<std::uint64_t> bloom;
+    if (bloomBitsPerEntry) {
+        header.bloomBits = 64;
+        while (header.bloomBits < header.entryCount * bloomBitsPerEntry) header.bloomBits <<= 1;
+        bloom.assign(header.bloomBits / 64, 0);
+        for (const auto& run : runs) {
+            for (const Entry& entry : run) {
+                for (std::uint32_t i = 0; i < header.bloomHashes; ++i) {
+                    std::uint64_t bit = positionIndex::bloomBit(entry.hash, i, header.bloomBits);
+                    bloom[bit / 64] |= std::uint64_t(1) << (bit % 64);
+                }
+            }
+        }
+    }
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Can't create the index " + outPath);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(bloom.data()), bloom.size() * sizeof(std::uint64_t));
+
+    // k-way merge of the sorted runs
+    using Head = std::pair<Entry, std::size_t>; // entry, run
+    auto greater = [](const Head& a, const Head& b) { return b.first < a.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+    std::vector<std::size_t> positions(runs.size(), 0);
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        if (!runs[r].empty()) heads.push({runs[r][0], r});
+    }
+    std::vector<Entry> buffer;
+    buffer.reserve(4096);
+    while (!heads.empty()) {
+        auto [entry, r] = heads.top();
+        heads.pop();
+        buffer.push_back(entry);
+        if (buffer.size() == buffer.capacity()) {
+            out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(Entry));
+            buffer.clear();
+        }
+        if (++positions[r] < runs[r].size()) heads.push({runs[r][positions[r]], r});
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(Entry));
+    if (!out) throw std::runtime_error("Index write failure " + outPath);
+    return header.entryCount;
+}
+
+class PositionIndex {
+public:
+    explicit PositionIndex(const std::string& path);
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+    PositionIndex(PositionIndex&&) = delete;
+    PositionIndex& operator=(PositionIndex&&) = delete;
+    ~PositionIndex();
+
+    bool mayContain(std::uint64_t hash) const;
+    std::vector<PositionHit> find(std::uint64_t hash) const;
+    std::vector<PositionHit> find(const Chess& chess) const {
+        return find(chess.getHash());
+    }
+    std::uint64_t size() const {
+        return m_header->entryCount;
+    }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    const positionIndex::Header* m_header = nullptr;
+    const std::uint64_t* m_bloom = nullptr;
+    const positionIndex::Entry* m_entries = nullptr;
+};
+
+PositionIndex::PositionIndex(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Can't open the index " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Can't open the index " + path);
+    }
+    m_size = st.st_size;
+    void* data = m_size >= sizeof(positionIndex::Header) ? ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("Can't map the index " + path);
+    m_data = static_cast<const char*>(data);
+    ::madvise(data, m_size, MADV_RANDOM);
+    m_header = reinterpret_cast<const positionIndex::Header*>(m_data);
+    // the Bloom filter is 0 or a power of 2 (>= 64) bits, mayContain masks the bit index with bloomBits - 1;
+    // the sizes are compared without overflow
+    const std::uint64_t bloomBits = m_header->bloomBits;
+    const std::uint64_t payload = m_size - sizeof(positionIndex::Header);
+    const bool bloomValid = !bloomBits || (bloomBits >= 64 && std::has_single_bit(bloomBits) &&
+                                           m_header->bloomHashes >= 1 && m_header->bloomHashes <= positionIndex::MAX_BLOOM_HASHES);
+    if (std::memcmp(m_header->magic, positionIndex::MAGIC, sizeof(positionIndex::MAGIC)) != 0 ||
+        m_header->version != positionIndex::VERSION || !bloomValid || bloomBits / 8 > payload ||
+        m_header->entryCount != (payload - bloomBits / 8) / sizeof(positionIndex::Entry) ||
+        (payload - bloomBits / 8) % sizeof(positionIndex::Entry)) {
+        ::munmap(data, m_size);
+        throw std::runtime_error("Not a position index " + path);
+    }
+    m_bloom = reinterpret_cast<const std::uint64_t*>(m_data + sizeof(positionIndex::Header));
+    m_entries = reinterpret_cast<const positionIndex::Entry*>(m_data + sizeof(positionIndex::Header) + bloomBits / 8);
+}
+
+PositionIndex::~PositionIndex() {
+    ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+// false means the position is surely not in the index, true means it may be
+bool PositionIndex::mayContain(std::uint64_t hash) const {
+    if (!m_header->bloomBits) return true;
+    for (std::uint32_t i = 0; i < m_header->bloomHashes; ++i) {
+        std::uint64_t bit = positionIndex::bloomBit(hash, i, m_header->bloomBits);
+        if (!(m_bloom[bit / 64] & (std::uint64_t(1) << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+std::vector<PositionHit> PositionIndex::find(std::uint64_t hash) const {
+    std::vector<PositionHit> hits;
+    if (!mayContain(hash)) return hits;
+    const positionIndex::Entry* end = m_entries + m_header->entryCount;
+    const positionIndex::Entry* iter = std::lower_bound(m_entries, end, hash,
+        [](const positionIndex::Entry& entry, std::uint64_t key) { return entry.hash < key; });
+    for (; iter != end && iter->hash == hash; ++iter) {
+        hits.push_back({iter->gameId, iter->ply});
+    }
+    return hits;
+}
+
+// replays the moves from the initial position and prints the games which reached the resulting position
+int findGames(const std::string& indexPath, const std::vector<std::string>& moves) {
+    Chess chess;
+    for (const std::string& move : moves) {
+        Move parsed = san::parseInput(chess, move); // "e2e4", "e7e8q" or SAN
+        if (parsed.isNull() || !chess.makeMove(chess.getSideToMove(), parsed)) {
+            std::cerr << "Illegal move " << move << std::endl;
+            return 1;
+        }
+    }
+    PositionIndex index(indexPath);
+    auto hits = index.find(chess);
+    for (const PositionHit& hit : hits) {
+        std::cout << "game " << hit.gameId << " ply " << hit.ply << '\n';
+    }
+    std::cout << "found: " << hits.size() << std::endl;
+    return 0;
+}
+
+} // CHESS
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * @file san.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Standard algebraic notation (SAN): "Nf3", "exd5", "O-O", "e8=Q+", "Nbd7", "R1e2".
+ *
+ *  parse reads a SAN move from a string_view in one pass, without allocations: the piece, the disambiguation,
+ *  the destination and the promotion are read, then the move is resolved against the legal moves of the
+ *  position (a match must be unique). The check and annotation suffixes are accepted and ignored.
+ *  parseInput accepts the coordinate form the game always had ("e2e4", "e2 e4", "e2-e4") as well;
+ *  a coordinate move is not resolved against the legal moves, Chess::makeMove validates it as before.
+ *
+ *  toSan writes the shortest unambiguous SAN of a legal move with its check or mate suffix.
+ *  The game always promotes to a queen: "=Q" is written for promotions, the other promotions don't parse.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SAN_H_
+#define SAN_H_
+
+#include "chess.hpp"
+#include "position.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CHESS {
+
+namespace san {
+
+// indexed by chessPiece::PIECE, pawns have no letter
+constexpr char PIECE_LETTERS[6] = {'K', 'Q', 'N', 'B', 'R', 0};
+
+inline chessPiece::PIECE pieceOfLetter(char letter) {
+    for (int piece = 0; piece < 5; ++piece) {
+        if (PIECE_LETTERS[piece] == letter) return static_cast<chessPiece::PIECE>(piece);
+    }
+    return chessPiece::PIECE::NONE;
+}
+
+inline bool isFile(char c) {
+    return c >= 'a' && c <= 'h';
+}
+
+inline bool isRank(char c) {
+    return c >= '1' && c <= '8';
+}
+
+// a null move if the text is not SAN, or no legal move or more than one matches it
+inline Move parse(std::string_view text, const Position& position, const std::vector<Move>& legal) {
+    while (!text.empty() && (text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?')) {
+        text.remove_suffix(1);
+    }
+    if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0") {
+        const int file = text.size() == 3 ? 6 : 2;
+        for (Move move : legal) {
+            if (move.type() == Move::TYPE::CASTLING && move.to() % 8 == file) return move;
+        }
+        return Move();
+    }
+
+    chessPiece::PIECE piece = chessPiece::PIECE::PAWN;
+    if (!text.empty() && pieceOfLetter(text.front()) != chessPiece::PIECE::NONE) {
+        piece = pieceOfLetter(text.front());
+        text.remove_prefix(1);
+    }
+    // "e8=Q" or "e8Q", only queens are played
+    if (piece == chessPiece::PIECE::PAWN && !text.empty() && pieceOfLetter(text.back()) != chessPiece::PIECE::NONE) {
+        if (text.back() != 'Q') return Move();
+        text.remove_suffix(1);
+        if (!text.empty() && text.back() == '=') text.remove_suffix(1);
+    }
+    if (text.size() < 2 || !isFile(text[text.size() - 2]) || !isRank(text.back())) return Move();
+    const int destination = (text[text.size() - 2] - 'a') + 8 * (text.back() - '1');
+    text.remove_suffix(2);
+    const bool capture = !text.empty() && text.back() == 'x';
+    if (capture) text.remove_suffix(1);
+
+    int file = -1, rank = -1;
+    for (char c : text) {
+        if (isFile(c) && file < 0 && rank < 0) file = c - 'a';
+        else if (isRank(c) && rank < 0) rank = c - '1';
+        else return Move();
+    }
+    // a pawn leaves its file only when it captures, the capture names the file it comes from
+    if (piece == chessPiece::PIECE::PAWN) {
+        if (capture != (file >= 0)) return Move();
+        if (!capture) file = destination % 8;
+    }
+
+    Move found;
+    for (Move move : legal) {
+        if (move.to() != destination || position.pieceAt(move.from()) != piece || move.type() == Move::TYPE::CASTLING) continue;
+        if ((file >= 0 && move.from() % 8 != file) || (rank >= 0 && move.from() / 8 != rank)) continue;
+        if (!found.isNull()) return Move(); // ambiguous
+        found = move;
+    }
+    return found;
+}
+
+// "e2e4", "e2 e4", "e2-e4": the first two squares, after the spaces and dashes
+inline bool parseCoordinates(std::string_view text, int& source, int& destination) {
+    char squares[4];
+    std::size_t count = 0;
+    for (char c : text) {
+        if (c == ' ' || c == '-') continue;
+        if (count == 4) break;
+        squares[count++] = c;
+    }
+    if (count < 4 || !isFile(squares[0]) || !isRank(squares[1]) || !isFile(squares[2]) || !isRank(squares[3])) return false;
+    source = (squares[0] - 'a') + 8 * (squares[1] - '1');
+    destination = (squares[2] - 'a') + 8 * (squares[3] - '1');
+    return true;
+}
+
+// a move of the side to move in the coordinate form or in SAN, a null move if it can't be read.
+// Only SAN needs the legal moves, they are generated into a per thread list.
+inline Move parseInput(Chess& chess, std::string_view text) {
+    int source, destination;
+    if (parseCoordinates(text, source, destination)) return Move(source, destination);
+    thread_local std::vector<Move> legal;
+    chess.getLegalMoves(legal);
+    return parse(text, chess.getPosition(), legal);
+}
+
+// the SAN of a legal move of the position, check and mate are those of the position after the move
+inline std::string toSan(Move move, const Position& position, const std::vector<Move>& legal, bool check, bool mate) {
+    std::string text;
+    const chessPiece::PIECE piece = position.pieceAt(move.from());
+    if (move.type() == Move::TYPE::CASTLING) {
+        text = move.to() % 8 == 6 ? "O-O" : "O-O-O";
+    } else if (piece == chessPiece::PIECE::PAWN) {
+        if (move.from() % 8 != move.to() % 8) {
+            text.push_back(static_cast<char>('a' + move.from() % 8));
+            text.push_back('x');
+        }
+        text += squareName(move.to());
+        if (move.type() == Move::TYPE::PROMOTION) text += "=Q";
+    } else {
+        text.push_back(PIECE_LETTERS[static_cast<int>(piece)]);
+        // the file if it tells the pieces apart, else the rank, else both
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        for (Move other : legal) {
+            if (other.to() != move.to() || other.from() == move.from() || position.pieceAt(other.from()) != piece) continue;
+            ambiguous = true;
+            sameFile = sameFile || other.from() % 8 == move.from() % 8;
+            sameRank = sameRank || other.from() / 8 == move.from() / 8;
+        }
+        if (ambiguous && (!sameFile || sameRank)) text.push_back(static_cast<char>('a' + move.from() % 8));
+        if (ambiguous && sameFile) text.push_back(static_cast<char>('1' + move.from() / 8));
+        if (position.occupancy() & squareBit(move.to())) text.push_back('x');
+        text += squareName(move.to());
+    }
+    if (mate) text.push_back('#');
+    else if (check) text.push_back('+');
+    return text;
+}
+
+// check and mate of the side to move of chess, the move has been played on it
+inline void findCheckAndMate(Chess& chess, bool& check, bool& mate) {
+    thread_local std::vector<Move> replies;
+    check = chess.getSideToMove() == chessPiece::COLOR::WHITE ? chess.isWhiteKingUnderAttack() : chess.isBlackKingUnderAttack();
+    mate = false;
+    if (check) {
+        chess.getLegalMoves(replies);
+        mate = replies.empty();
+    }
+}
+
+// the SAN of a legal move of the side to move of chess, chess is not changed:
+// the position after the move is set up on a per thread scratch Chess
+inline std::string toSan(Chess& chess, Move move) {
+    thread_local std::vector<Move> legal;
+    thread_local Chess next;
+    chess.getLegalMoves(legal);
+    const Position position = chess.getPosition();
+    Position after = position;
+    after.makeMove(move);
+    next.setPosition(after);
+    bool check, mate;
+    findCheckAndMate(next, check, mate);
+    return toSan(move, position, legal, check, mate);
+}
+
+// "1. e4 e5 2. Nf3" for the moves played from the initial position,
+// every move is played on the same Chess and its check and mate are read there
+inline std::string toSanLine(const std::vector<Move>& moves) {
+    std::string line;
+    Chess chess;
+    std::vector<Move> legal;
+    for (std::size_t ply = 0; ply < moves.size(); ++ply) {
+        if (ply % 2 == 0) line += std::to_string(ply / 2 + 1) + ". ";
+        chess.getLegalMoves(legal);
+        const Position position = chess.getPosition();
+        chess.makeMove(chess.getSideToMove(), moves[ply]);
+        bool check, mate;
+        findCheckAndMate(chess, check, mate);
+        line += toSan(moves[ply], position, legal, check, mate);
+        line.push_back(' ');
+    }
+    return line;
+}
+
+} // san
+
+} // CHESS
+
+#endif
@@ -0,0 +1,453 @@
+/**
+ * @file search.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Multi-PV analysis: the best K root moves of a position with their scores and lines.
+ *
+ *  Alpha-beta (negamax, principal variation search) with iterative deepening, a quiescence search over
+ *  captures and promotions, and a transposition table. Positions are copy-made: a child is a copy of its
+ *  parent Position with Position::makeMove applied, the legal moves of a node come from a scratch Chess
+ *  loaded with Chess::setPosition, so the search follows exactly the rules of the game.
+ *
+ *  At every depth line 1 is searched over all the root moves, line k over the root moves which are not
+ *  the best moves of the lines before it. Each line starts with an aspiration window around its score of the
+ *  previous depth, widened on a fail. The transposition table is shared by all the lines and depths:
+ *  the subtrees under the root moves are the same for every line, so after line 1 the other lines
+ *  mostly find their positions in the table, and K lines cost far less than K single-line searches.
+ *  The root is not stored in the table, its best move depends on the excluded moves.
+ *
+ *  A line is reported once it is done at a depth, through the callback of analyse.
+ *  Scores are in centipawns from the side to move's point of view. Repetitions are detected along the searched line only.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include "chess.hpp"
+#include "endgame.hpp"
+#include "evaluation.hpp"
+#include "position.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace CHESS {
+
+namespace search {
+
+constexpr int MAX_PLY = 64;
+constexpr int INFINITE_SCORE = 32000;
+constexpr int MATE = 31000; // mate at ply p scores MATE - p
+constexpr int ASPIRATION_WINDOW = 50;
+
+inline bool isMateScore(int score) {
+    return std::abs(score) >= MATE - MAX_PLY;
+}
+
+struct SearchInfo {
+    int depth = 0;
+    int line = 0; // 1 for the best line
+    int score = 0;
+    std::uint64_t nodes = 0; // of the whole analysis so far
+    std::int64_t milliseconds = 0;
+    std::vector<Move> pv;
+};
+
+// "info depth 4 line 1 score 35 nodes 5210 time 84 pv e2e4 e7e5", the score is "mate N" for a forced mate
+// (negative if the side to move is mated)
+inline std::string formatInfo(const SearchInfo& info) {
+    std::ostringstream out;
+    out << "info depth " << info.depth << " line " << info.line << " score ";
+    if (isMateScore(info.score)) {
+        out << "mate " << (info.score > 0 ? (MATE - info.score + 1) / 2 : -(MATE + info.score) / 2);
+    } else {
+        out << info.score;
+    }
+    out << " nodes " << info.nodes << " time " << info.milliseconds << " pv";
+    for (Move move : info.pv) {
+        out << ' ' << move.source() << move.destination();
+    }
+    return out.str();
+}
+
+// "analyse [depth] [lines]", false for any other input
+inline bool parseAnalyse(const std::string& text, int& depth, int& lines) {
+    std::istringstream in(text);
+    std::string command;
+    in >> command;
+    if (command != "analyse") return false;
+    depth = 4;
+    lines = 3;
+    if (in >> depth) in >> lines;
+    depth = std::clamp(depth, 1, MAX_PLY / 2);
+    lines = std::clamp(lines, 1, 32);
+    return true;
+}
+
+class TranspositionTable {
+public:
+    enum BOUND : std::uint8_t { EXACT, LOWER, UPPER };
+
+    struct Entry {
+        std::uint64_t key = 0;
+        std::int16_t score = 0;
+        std::uint8_t depth = 0;
+        std::uint8_t bound = EXACT;
+        std::uint16_t move = 0; // Move::raw
+    };
+
+    explicit TranspositionTable(std::size_t entries = 1 << 18); // rounded down to a power of 2
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+    TranspositionTable(TranspositionTable&&) = default;
+    TranspositionTable& operator=(TranspositionTable&&) = default;
+    ~TranspositionTable() = default;
+
+    const Entry* probe(std::uint64_t key) const {
+        const Entry& entry = m_entries[key & m_mask];
+        return entry.key == key ? &entry : nullptr;
+    }
+    void store(std::uint64_t key, int depth, int score, BOUND bound, Move move);
+    void clear();
+
+private:
+    std::vector<Entry> m_entries;
+    std::uint64_t m_mask;
+};
+
+TranspositionTable::TranspositionTable(std::size_t entries) {
+    std::size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    m_entries.resize(size);
+    m_mask = size - 1;
+}
+
+// a deeper entry of another position is kept, the same position is always refreshed
+void TranspositionTable::store(std::uint64_t key, int depth, int score, BOUND bound, Move move) {
+    Entry& entry = m_entries[key & m_mask];
+    if (entry.key != key && entry.depth > depth) return;
+    if (entry.key == key && move.isNull()) move = Move::fromRaw(entry.move); // keep the known best move
+    entry.key = key;
+    entry.score = static_cast<std::int16_t>(score);
+    entry.depth = static_cast<std::uint8_t>(depth);
+    entry.bound = bound;
+    entry.move = move.raw();
+}
+
+void TranspositionTable::clear() {
+    std::fill(m_entries.begin(), m_entries.end(), Entry{});
+}
+
+class Search {
+public:
+    using Report = std::function<void(const SearchInfo&)>;
+
+    explicit Search(std::size_t tableEntries = 1 << 18) : m_table(tableEntries) {}
+    Search(const Search&) = delete;
+    Search& operator=(const Search&) = delete;
+    Search(Search&&) = delete;
+    Search& operator=(Search&&) = delete;
+    ~Search() = default;
+
+    // the lines of the last depth, best first; fewer than lines if there are fewer legal moves
+    std::vector<SearchInfo> analyse(const Position& root, int depth, int lines, const Report& report = {});
+    std::uint64_t getNodes() const {
+        return m_nodes;
+    }
+    void clear() {
+        m_table.clear();
+    }
+
+private:
+    int searchRoot(const Position& root, int depth, int alpha, int beta);
+    int search(const Position& position, int depth, int alpha, int beta, int ply);
+    int quiescence(const Position& position, int alpha, int beta, int ply);
+    bool generate(const Position& position, std::vector<Move>& moves); // true if the side to move is in check
+    void order(const Position& position, std::vector<Move>& moves, Move best, int ply);
+    bool isRepetition(const Position& position, int ply) const;
+    void updatePv(int ply, Move move);
+
+    // the endgame handler of the material if there is one, one table probe
+    static int evaluate(const Position& position) {
+        const endgame::Endgames& endgames = endgame::defaultEndgames();
+        const endgame::Handler* p_handler = endgames.probe(material::keyOf(position));
+        int score = p_handler ? endgames.evaluate(position, *p_handler) : evaluation::evaluate(position).total();
+        return position.side() == chessPiece::COLOR::WHITE ? score : -score;
+    }
+    // mate scores are stored relative to the node, not to the root
+    static int toTable(int score, int ply) {
+        return score >= MATE - MAX_PLY ? score + ply : score <= -(MATE - MAX_PLY) ? score - ply : score;
+    }
+    static int fromTable(int score, int ply) {
+        return score >= MATE - MAX_PLY ? score - ply : score <= -(MATE - MAX_PLY) ? score + ply : score;
+    }
+
+    Chess m_chess; // move generation of the node being expanded
+    TranspositionTable m_table;
+    std::uint64_t m_nodes = 0;
+    std::vector<Move> m_rootMoves;    // in search order
+    std::vector<Move> m_excluded;     // root moves of the lines already done at this depth
+    std::vector<Move> m_moves[MAX_PLY];
+    std::vector<int> m_scores[MAX_PLY];
+    Move m_killers[MAX_PLY][2];
+    Move m_pv[MAX_PLY][MAX_PLY];
+    int m_pvLength[MAX_PLY] = {};
+    std::uint64_t m_path[MAX_PLY] = {}; // hashes of the searched line
+};
+
+std::vector<SearchInfo> Search::analyse(const Position& root, int depth, int lines, const Report& report) {
+    const auto start = std::chrono::steady_clock::now();
+    m_nodes = 0;
+    for (auto& killers : m_killers) {
+        killers[0] = killers[1] = Move();
+    }
+    generate(root, m_rootMoves);
+    m_path[0] = root.hash;
+    lines = std::min<int>(lines, m_rootMoves.size());
+    std::vector<SearchInfo> result;
+    for (int d = 1; d <= depth; ++d) {
+        std::vector<SearchInfo> current;
+        m_excluded.clear();
+        for (int line = 0; line < lines; ++line) {
+            int alpha = -INFINITE_SCORE, beta = INFINITE_SCORE;
+            int window = ASPIRATION_WINDOW;
+            if (line < static_cast<int>(result.size()) && !isMateScore(result[line].score)) {
+                alpha = result[line].score - window;
+                beta = result[line].score + window;
+            }
+            int score;
+            while (true) {
+                score = searchRoot(root, d, alpha, beta);
+                if (score <= alpha && alpha > -INFINITE_SCORE) {
+                    alpha = std::max(score - window, -INFINITE_SCORE);
+                } else if (score >= beta && beta < INFINITE_SCORE) {
+                    beta = std::min(score + window, INFINITE_SCORE);
+                } else {
+                    break;
+                }
+                window *= 2;
+            }
+            SearchInfo info;
+            info.depth = d;
+            info.line = line + 1;
+            info.score = score;
+            info.pv.assign(m_pv[0], m_pv[0] + m_pvLength[0]);
+            info.nodes = m_nodes;
+            info.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            m_excluded.push_back(info.pv.front());
+            if (report) report(info);
+            current.push_back(std::move(info));
+        }
+        // the next depth tries the lines in their order first
+        std::stable_partition(m_rootMoves.begin(), m_rootMoves.end(), [this](Move move) {
+            return std::find(m_excluded.begin(), m_excluded.end(), move) != m_excluded.end();
+        });
+        std::stable_sort(m_rootMoves.begin(), m_rootMoves.begin() + m_excluded.size(), [this](Move a, Move b) {
+            return std::find(m_excluded.begin(), m_excluded.end(), a) < std::find(m_excluded.begin(), m_excluded.end(), b);
+        });
+        result = std::move(current);
+    }
+    return result;
+}
+
+// the best of the root moves which are not excluded, fail-soft
+int Search::searchRoot(const Position& root, int depth, int alpha, int beta) {
+    ++m_nodes;
+    m_pvLength[0] = 0;
+    int best = -INFINITE_SCORE;
+    bool first = true;
+    for (Move move : m_rootMoves) {
+        if (std::find(m_excluded.begin(), m_excluded.end(), move) != m_excluded.end()) continue;
+        Position child = root;
+        child.makeMove(move);
+        m_path[1] = child.hash;
+        int score;
+        if (first) {
+            score = -search(child, depth - 1, -beta, -alpha, 1);
+        } else {
+            score = -search(child, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta) score = -search(child, depth - 1, -beta, -alpha, 1);
+        }
+        if (score > best || first) {
+            best = score;
+            updatePv(0, move);
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) break;
+        }
+        first = false;
+    }
+    return best;
+}
+
+int Search::search(const Position& position, int depth, int alpha, int beta, int ply) {
+    if (depth <= 0) return quiescence(position, alpha, beta, ply);
+    ++m_nodes;
+    m_pvLength[ply] = ply;
+    if (isRepetition(position, ply)) return 0;
+    if (ply >= MAX_PLY - 1) return evaluate(position);
+
+    const bool pvNode = beta - alpha > 1;
+    Move tableMove;
+    if (const auto* p_entry = m_table.probe(position.hash)) {
+        tableMove = Move::fromRaw(p_entry->move);
+        int score = fromTable(p_entry->score, ply);
+        // no cut at the PV nodes, their lines are reported
+        if (!pvNode && p_entry->depth >= depth &&
+            (p_entry->bound == TranspositionTable::EXACT ||
+             (p_entry->bound == TranspositionTable::LOWER && score >= beta) ||
+             (p_entry->bound == TranspositionTable::UPPER && score <= alpha))) {
+            return score;
+        }
+    }
+
+    auto& moves = m_moves[ply];
+    bool inCheck = generate(position, moves);
+    if (moves.empty()) return inCheck ? -(MATE - ply) : 0;
+    order(position, moves, tableMove, ply);
+
+    const int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    Move bestMove;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        Position child = position;
+        child.makeMove(move);
+        m_path[ply + 1] = child.hash;
+        int score;
+        if (i == 0) {
+            score = -search(child, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            score = -search(child, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta) score = -search(child, depth - 1, -beta, -alpha, ply + 1);
+        }
+        if (score <= best) continue;
+        best = score;
+        bestMove = move;
+        if (score <= alpha) continue;
+        alpha = score;
+        updatePv(ply, move);
+        if (alpha >= beta) {
+            if (!(position.occupancy() & squareBit(move.to())) && move != m_killers[ply][0]) {
+                m_killers[ply][1] = m_killers[ply][0];
+                m_killers[ply][0] = move;
+            }
+            break;
+        }
+    }
+    TranspositionTable::BOUND bound = best >= beta ? TranspositionTable::LOWER :
+                                      best > originalAlpha ? TranspositionTable::EXACT : TranspositionTable::UPPER;
+    m_table.store(position.hash, depth, toTable(best, ply), bound, bound == TranspositionTable::UPPER ? Move() : bestMove);
+    return best;
+}
+
+// captures and promotions until the position is quiet, the side to move may stand pat
+int Search::quiescence(const Position& position, int alpha, int beta, int ply) {
+    ++m_nodes;
+    m_pvLength[ply] = ply;
+    int best = evaluate(position);
+    if (best >= beta || ply >= MAX_PLY - 1) return best;
+    if (best > alpha) alpha = best;
+
+    auto& moves = m_moves[ply];
+    bool inCheck = generate(position, moves);
+    if (moves.empty()) return inCheck ? -(MATE - ply) : 0;
+    const std::uint64_t opponents = position.colors[1 - position.sideToMove];
+    std::erase_if(moves, [opponents](Move move) {
+        return !(opponents & squareBit(move.to())) && move.type() != Move::TYPE::EN_PASSANT && move.type() != Move::TYPE::PROMOTION;
+    });
+    order(position, moves, Move(), ply);
+
+    for (Move move : moves) {
+        Position child = position;
+        child.makeMove(move);
+        int score = -quiescence(child, -beta, -alpha, ply + 1);
+        if (score <= best) continue;
+        best = score;
+        if (score <= alpha) continue;
+        alpha = score;
+        updatePv(ply, move);
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+bool Search::generate(const Position& position, std::vector<Move>& moves) {
+    m_chess.setPosition(position);
+    m_chess.getLegalMoves(moves);
+    if (!moves.empty()) return false; // only asked for mates and stalemates
+    return position.side() == chessPiece::COLOR::WHITE ? m_chess.isWhiteKingUnderAttack() : m_chess.isBlackKingUnderAttack();
+}
+
+// the table move, captures by the most valuable victim and the least valuable attacker, promotions, killers, the rest
+void Search::order(const Position& position, std::vector<Move>& moves, Move best, int ply) {
+    auto& scores = m_scores[ply];
+    scores.resize(moves.size());
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        int score = 0;
+        chessPiece::PIECE victim = position.pieceAt(move.to());
+        if (move == best) {
+            score = 1 << 20;
+        } else if (victim != chessPiece::PIECE::NONE || move.type() == Move::TYPE::EN_PASSANT) {
+            int value = victim == chessPiece::PIECE::NONE ? evaluation::MATERIAL[static_cast<int>(chessPiece::PIECE::PAWN)] :
+                                                            evaluation::MATERIAL[static_cast<int>(victim)];
+            score = (1 << 18) + value * 16 - evaluation::MATERIAL[static_cast<int>(position.pieceAt(move.from()))] / 16;
+        } else if (move.type() == Move::TYPE::PROMOTION) {
+            score = 1 << 17;
+        } else if (move == m_killers[ply][0]) {
+            score = 2;
+        } else if (move == m_killers[ply][1]) {
+            score = 1;
+        }
+        scores[i] = score;
+    }
+    // insertion sort, the lists are short
+    for (std::size_t i = 1; i < moves.size(); ++i) {
+        Move move = moves[i];
+        int score = scores[i];
+        std::size_t j = i;
+        for (; j > 0 && scores[j - 1] < score; --j) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+// the same position with the same side to move earlier in the line, since the last capture or pawn move
+bool Search::isRepetition(const Position& position, int ply) const {
+    for (int i = ply - 2; i >= 0 && i >= ply - position.halfmoveClock; i -= 2) {
+        if (m_path[i] == position.hash) return true;
+    }
+    return false;
+}
+
+void Search::updatePv(int ply, Move move) {
+    m_pv[ply][ply] = move;
+    for (int i = ply + 1; i < m_pvLength[ply + 1]; ++i) {
+        m_pv[ply][i] = m_pv[ply + 1][i];
+    }
+    m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+}
+
+} // search
+
+// the analysis of the current position of chess, every finished line goes to report
+inline std::vector<search::SearchInfo> analyse(const Chess& chess, int depth, int lines, const search::Search::Report& report = {}) {
+    search::Search search;
+    return search.analyse(chess.getPosition(), depth, lines, report);
+}
+
+} // CHESS
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file squareList.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  StaticVector: a vector with a fixed capacity inside the object, for the hot paths which must not allocate.
+ *  SquareList holds squares (squareIndex values, a1 = 0). 27 is the most squares a piece can attack
+ *  (a queen in the centre of an empty board), a pawn's attacks and pushes are 4 at most.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SQUARELIST_H_
+#define SQUARELIST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace CHESS {
+
+inline int squareIndex(const std::string& position) {
+    return (position[0] - 'a') + 8 * (position[1] - '1');
+}
+
+inline std::string squareName(int index) {
+    return {static_cast<char>('a' + index % 8), static_cast<char>('1' + index / 8)};
+}
+
+template <typename T, std::size_t N>
+class StaticVector {
+public:
+    StaticVector() = default;
+    StaticVector(const StaticVector&) = default;
+    StaticVector& operator=(const StaticVector&) = default;
+    StaticVector(StaticVector&&) = default;
+    StaticVector& operator=(StaticVector&&) = default;
+    ~StaticVector() = default;
+
+    void push_back(const T& value) {
+        if (m_size == N) throw std::logic_error("StaticVector capacity exceeded");
+        m_data[m_size++] = value;
+    }
+    void pop_back() {
+        --m_size;
+    }
+    void clear() {
+        m_size = 0;
+    }
+    bool contains(const T& value) const {
+        for (std::size_t i = 0; i < m_size; ++i) {
+            if (m_data[i] == value) return true;
+        }
+        return false;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+    bool empty() const {
+        return m_size == 0;
+    }
+    static constexpr std::size_t capacity() {
+        return N;
+    }
+    const T& operator[](std::size_t i) const {
+        return m_data[i];
+    }
+    T& operator[](std::size_t i) {
+        return m_data[i];
+    }
+    const T& back() const {
+        return m_data[m_size - 1];
+    }
+    const T* begin() const {
+        return m_data;
+    }
+    const T* end() const {
+        return m_data + m_size;
+    }
+
+private:
+    T m_data[N];
+    std::size_t m_size = 0;
+};
+
+using SquareList = StaticVector<std::uint8_t, 27>;
+
+// one bit per square, bit i is square i (squareIndex)
+inline std::uint64_t squareBit(int square) {
+    return std::uint64_t(1) << square;
+}
+
+} // CHESS
+
+#endif
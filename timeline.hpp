@@ -0,0 +1,121 @@
+/**
+ * @file timeline.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Timeline: takeback, redo and "go to ply N" for a game played on a Chess.
+ *
+ *  Chess::move deletes the captured pieces, so a move can't be unmade on the board. The timeline keeps
+ *  the moves of the line (the ones after the current ply can be redone) and a Position snapshot every
+ *  SNAPSHOT_INTERVAL plies. Going to a ply restores the nearest snapshot at or before it with
+ *  Chess::setPosition and replays fewer than SNAPSHOT_INTERVAL moves, so the cost doesn't depend on
+ *  the length of the game. The move history of the Chess is restored as well (the repetition check and
+ *  en passant read it). A redo of the next ply only plays the move.
+ *
+ *  A move played after a takeback drops the moves which could be redone.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include "chess.hpp"
+#include "position.hpp"
+#include <string>
+#include <vector>
+
+namespace CHESS {
+
+class Timeline {
+public:
+    static constexpr int SNAPSHOT_INTERVAL = 16;
+
+    explicit Timeline(Chess& chess); // the current position of chess is ply 0
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+    Timeline(Timeline&&) = delete;
+    Timeline& operator=(Timeline&&) = delete;
+    ~Timeline() = default;
+
+    void record(Move move); // the move has just been played on the Chess at the current ply
+    bool takeback() {
+        return seek(m_ply - 1);
+    }
+    bool redo() {
+        return seek(m_ply + 1);
+    }
+    bool seek(int ply); // false if the ply is not in the line, nothing is changed then
+
+    // "takeback", "redo", "goto N": the ply to go to, false for any other input
+    bool parse(const std::string& text, int& ply) const;
+
+    int ply() const {
+        return m_ply;
+    }
+    int plies() const {
+        return static_cast<int>(m_moves.size());
+    }
+
+private:
+    Chess& m_chess;
+    std::vector<Move> m_history;       // of the Chess before ply 0
+    std::vector<Move> m_moves;         // the whole line from ply 0
+    std::vector<Position> m_snapshots; // the position of ply i * SNAPSHOT_INTERVAL, up to the end of the line
+    int m_ply = 0;
+};
+
+Timeline::Timeline(Chess& chess) : m_chess(chess), m_history(chess.getMoveDB()) {
+    m_snapshots.push_back(chess.getPosition());
+}
+
+void Timeline::record(Move move) {
+    m_moves.resize(m_ply);
+    m_snapshots.resize(m_ply / SNAPSHOT_INTERVAL + 1);
+    m_moves.push_back(move);
+    if (++m_ply % SNAPSHOT_INTERVAL == 0) m_snapshots.push_back(m_chess.getPosition());
+}
+
+bool Timeline::seek(int ply) {
+    if (ply < 0 || ply > plies()) return false;
+    if (ply == m_ply + 1) {
+        m_chess.makeMove(m_chess.getSideToMove(), m_moves[m_ply]);
+    } else if (ply != m_ply) {
+        const int snapshot = ply / SNAPSHOT_INTERVAL;
+        m_chess.setPosition(m_snapshots[snapshot]);
+        for (int i = snapshot * SNAPSHOT_INTERVAL; i < ply; ++i) {
+            m_chess.makeMove(m_chess.getSideToMove(), m_moves[i]);
+        }
+        std::vector<Move>& history = m_chess.getMoveDB();
+        history = m_history;
+        history.insert(history.end(), m_moves.begin(), m_moves.begin() + ply);
+    }
+    m_ply = ply;
+    return true;
+}
+
+bool Timeline::parse(const std::string& text, int& ply) const {
+    if (text == "takeback") {
+        ply = m_ply - 1;
+        return true;
+    }
+    if (text == "redo") {
+        ply = m_ply + 1;
+        return true;
+    }
+    if (text.rfind("goto ", 0) != 0) return false;
+    try {
+        std::size_t end = 0;
+        ply = std::stoi(text.substr(5), &end);
+        return end == text.size() - 5;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+} // CHESS
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file zobrist.hpp
+ * @author Ashot Petrosyan (ashotpetrossian91@gmail.com)
+ * @brief
+ *  Zobrist keys for position hashing.
+ *  The table is generated at compile time by splitmix64 from a fixed seed,
+ *  so hashes are stable between builds and can be stored in files.
+ *  Piece keys are indexed [color][piece][square], where piece follows chessPiece::PIECE
+ *  and the square follows squareIndex (a1 = 0).
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include <cstdint>
+
+namespace CHESS {
+
+namespace zobrist {
+
+enum CASTLING : std::uint8_t { WHITE_KING_SIDE = 1, WHITE_QUEEN_SIDE = 2, BLACK_KING_SIDE = 4, BLACK_QUEEN_SIDE = 8 };
+
+struct Keys {
+    std::uint64_t piece[2][6][64];
+    std::uint64_t castling[4];
+    std::uint64_t enPassant[8];
+    std::uint64_t blackToMove;
+};
+
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys generate() {
+    Keys keys{};
+    std::uint64_t state = 0x43484553535A4F42ULL;
+    for (auto& color : keys.piece) {
+        for (auto& piece : color) {
+            for (auto& square : piece) {
+                square = splitmix64(state);
+            }
+        }
+    }
+    for (auto& key : keys.castling) key = splitmix64(state);
+    for (auto& key : keys.enPassant) key = splitmix64(state);
+    keys.blackToMove = splitmix64(state);
+    return keys;
+}
+
+inline constexpr Keys KEYS = generate();
+
+} // zobrist
+
+} // CHESS
+
+#endif